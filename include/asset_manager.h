@@ -0,0 +1,679 @@
+#ifndef ASSET_MANAGER_H
+#define ASSET_MANAGER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <stb_image.h>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/mesh.h>
+
+#include <gl_resources.h>
+#include <lod.h>
+#include <texture_arrays.h>
+#include <texture_streaming.h>
+#include <trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asinhrono ucitavanje modela.
+//
+// LoadModel odmah vraca handle. Pozadinska nit radi Assimp import, dekodiranje tekstura
+// i pravljenje LOD nivoa; render nit u Update() salje podatke na GPU u malim koracima,
+// u okviru zadatog vremena po frejmu. Dok model nije ucitan crta se njegov bounding box.
+
+typedef int ModelHandle;
+
+enum class AssetState {
+    Queued,
+    Importing,
+    Uploading,
+    Resident,
+    Failed
+};
+
+inline const char *AssetStateName(AssetState state) {
+    switch (state) {
+        case AssetState::Queued: return "queued";
+        case AssetState::Importing: return "importing";
+        case AssetState::Uploading: return "uploading";
+        case AssetState::Resident: return "resident";
+        case AssetState::Failed: return "failed";
+    }
+    return "";
+}
+
+// rezultat pozadinskog importa (samo CPU podaci)
+struct ImportedTexture {
+    std::string path;
+    std::string type;
+    int width = 0;
+    int height = 0;
+    int components = 0;
+    unsigned char *data = nullptr;
+
+    // RGBA8 kopija u velicini sloja niza tekstura (priprema se na radnoj niti)
+    std::vector<unsigned char> layerPixels;
+    int layerWidth = 0;
+    int layerHeight = 0;
+
+    // kes mipmapa i rep lanca (kada je ukljuceno strimovanje tekstura)
+    streaming::TextureSource stream;
+};
+
+struct ImportedMesh {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> textures;     // indeksi u ImportedModel::textures
+    MeshLodData lods;
+};
+
+struct ImportedModel {
+    std::vector<ImportedMesh> meshes;
+    std::vector<ImportedTexture> textures;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    unsigned int layerCount = 0;
+    double importMs = 0.0;
+};
+
+struct ModelAsset {
+    std::string path;
+    std::string texturePrefix;
+    std::atomic<AssetState> state;
+    bool hasBounds = false;
+    glm::vec3 boundsMin = glm::vec3(-0.5f);
+    glm::vec3 boundsMax = glm::vec3(0.5f);
+
+    std::vector<Mesh> meshes;
+    LodModel lod;
+    std::vector<MeshLodData> lodData;     // indeksi svih LOD nivoa ostaju i na CPU (za spojeni bafer geometrije)
+
+    // stanje otpremanja na GPU
+    std::unique_ptr<ImportedModel> imported;
+    std::vector<GlTexture> textures;
+    std::vector<int> streamedTextures;            // handle-ovi TextureStreamer-a (-1 ako tekstura nije ucitana)
+    std::vector<TextureLayer> textureLayers;      // isti indeksi kao textures
+    std::vector<std::vector<unsigned int>> meshTextures;  // indeksi uvezenih tekstura, redom kao Mesh::textures
+    std::vector<GlVertexArray> meshArrays;
+    std::vector<GlBuffer> meshBuffers;
+    unsigned int nextTexture = 0;
+    int nextTextureRow = 0;
+    unsigned int nextLayer = 0;
+    int nextLayerRow = 0;
+    unsigned int nextMesh = 0;
+    size_t nextMeshByte = 0;                      // temena pa indeksi mreze nextMesh
+    GlVertexArray meshVAO;                        // mreza koja se trenutno otprema
+    GlBuffer meshVBO, meshEBO;
+    double importMs = 0.0;
+    double uploadMs = 0.0;
+
+    ModelAsset() : state(AssetState::Queued) {}
+
+    float Progress() const {
+        if (state == AssetState::Resident)
+            return 1.0f;
+        if (!imported)
+            return 0.0f;
+        size_t total = imported->textures.size() + imported->layerCount + imported->meshes.size();
+        unsigned int layers = imported->layerCount > 0 ? nextLayer : 0;
+        return total == 0 ? 1.0f : (float) (nextTexture + layers + nextMesh) / (float) total;
+    }
+};
+
+namespace assets {
+
+inline void ProcessMesh(aiMesh *mesh, const aiScene *scene, const std::string &directory, ImportedModel &out) {
+    ImportedMesh result;
+    result.vertices.resize(mesh->mNumVertices);
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+        Vertex vertex = {};
+        vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+        if (mesh->HasNormals())
+            vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+        if (mesh->mTextureCoords[0]) {
+            vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+            vertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+            vertex.Bitangent = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+        }
+        result.vertices[i] = vertex;
+
+        out.boundsMin = glm::min(out.boundsMin, vertex.Position);
+        out.boundsMax = glm::max(out.boundsMax, vertex.Position);
+    }
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+        const aiFace &face = mesh->mFaces[i];
+        for (unsigned int j = 0; j < face.mNumIndices; j++)
+            result.indices.push_back(face.mIndices[j]);
+    }
+
+    // isti tipovi i imena tekstura kao u Model::processMesh
+    const aiTextureType types[] = {aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_AMBIENT};
+    const char *names[] = {"texture_diffuse", "texture_specular", "texture_normal", "texture_height"};
+    aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+    for (int t = 0; t < 4; t++) {
+        for (unsigned int i = 0; i < material->GetTextureCount(types[t]); i++) {
+            aiString str;
+            material->GetTexture(types[t], i, &str);
+            std::string path = directory + '/' + str.C_Str();
+
+            unsigned int index = 0;
+            while (index < out.textures.size() && out.textures[index].path != path)
+                index++;
+            if (index == out.textures.size()) {
+                ImportedTexture texture;
+                texture.path = path;
+                texture.type = names[t];
+                out.textures.push_back(texture);
+            }
+            result.textures.push_back(index);
+        }
+    }
+
+    result.lods = BuildMeshLods(result.vertices, result.indices);
+    out.meshes.push_back(std::move(result));
+}
+
+inline void ProcessNode(aiNode *node, const aiScene *scene, const std::string &directory, ImportedModel &out) {
+    for (unsigned int i = 0; i < node->mNumMeshes; i++)
+        ProcessMesh(scene->mMeshes[node->mMeshes[i]], scene, directory, out);
+    for (unsigned int i = 0; i < node->mNumChildren; i++)
+        ProcessNode(node->mChildren[i], scene, directory, out);
+}
+
+// decodeTextures = false: teksture se ne dekodiraju (strimuju se iz kesa mipmapa)
+inline bool ImportModel(const std::string &path, ImportedModel &out, bool decodeTextures = true) {
+    Assimp::Importer importer;
+    // JoinIdenticalVertices: OBJ inace daje svakom uglu trougla posebno teme
+    const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals |
+                                                   aiProcess_FlipUVs | aiProcess_CalcTangentSpace |
+                                                   aiProcess_JoinIdenticalVertices);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+        return false;
+    }
+
+    out.boundsMin = glm::vec3(1e30f);
+    out.boundsMax = glm::vec3(-1e30f);
+    ProcessNode(scene->mRootNode, scene, path.substr(0, path.find_last_of('/')), out);
+
+    for (ImportedTexture &texture : out.textures) {
+        if (!decodeTextures)
+            break;
+        TraceZone zone("Decode texture", "asset");
+        texture.data = stbi_load(texture.path.c_str(), &texture.width, &texture.height, &texture.components, 0);
+        if (!texture.data)
+            std::cout << "Texture failed to load at path: " << texture.path << std::endl;
+    }
+    return true;
+}
+
+} // namespace assets
+
+class AssetManager {
+public:
+    AssetManager() {
+        worker = std::thread(&AssetManager::WorkerLoop, this);
+    }
+
+    ~AssetManager() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        worker.join();
+
+        for (auto &asset : models)
+            if (asset->imported)
+                for (ImportedTexture &texture : asset->imported->textures)
+                    stbi_image_free(texture.data);
+        for (auto &item : imported)
+            for (ImportedTexture &texture : item.second->textures)
+                stbi_image_free(texture.data);
+    }
+
+    // odmah vraca handle, import se radi u pozadini
+    ModelHandle LoadModel(const std::string &path, const std::string &texturePrefix = "") {
+        std::unique_ptr<ModelAsset> asset(new ModelAsset);
+        asset->path = path;
+        asset->texturePrefix = texturePrefix;
+        asset->lod.meshes = &asset->meshes;
+
+        ModelHandle handle = (ModelHandle) models.size();
+        ModelAsset *pending = asset.get();
+        models.push_back(std::move(asset));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            importQueue.emplace_back(handle, pending);
+        }
+        condition.notify_one();
+        return handle;
+    }
+
+    // teksture modela se pakuju i u nizove tekstura (za MDI putanju); poziva se pre prvog LoadModel
+    void EnableTextureArrays(TextureArrayManager *manager) {
+        textureArrays = manager;
+    }
+
+    // teksture modela se strimuju po mip nivoima umesto punog otpremanja; poziva se pre prvog LoadModel
+    void EnableStreaming(TextureStreamer *textureStreamer) {
+        streamer = textureStreamer;
+    }
+
+    // zahtev za detaljnost svih tekstura modela prema velicini na ekranu
+    void RequestTextures(ModelHandle handle, float projectedPixels) {
+        if (!streamer)
+            return;
+        for (int texture : models[handle]->streamedTextures)
+            streamer->Request(texture, projectedPixels);
+    }
+
+    ModelAsset &Get(ModelHandle handle) {
+        return *models[handle];
+    }
+
+    bool IsResident(ModelHandle handle) const {
+        return models[handle]->state == AssetState::Resident;
+    }
+
+    // ucitavanje je zavrseno, uspesno ili ne (neuspeli model se vise nece promeniti)
+    bool IsSettled(ModelHandle handle) const {
+        AssetState state = models[handle]->state;
+        return state == AssetState::Resident || state == AssetState::Failed;
+    }
+
+    unsigned int Count() const {
+        return (unsigned int) models.size();
+    }
+
+    // render nit: preuzimanje zavrsenih importa i otpremanje na GPU dok ne istekne budzet
+    void Update(double budgetMs) {
+        TraceZone zone("Asset upload", "asset");
+        std::vector<std::pair<ModelHandle, std::unique_ptr<ImportedModel>>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.swap(imported);
+        }
+        for (auto &item : ready) {
+            ModelAsset &asset = *models[item.first];
+            asset.imported = std::move(item.second);
+            asset.boundsMin = asset.imported->boundsMin;
+            asset.boundsMax = asset.imported->boundsMax;
+            asset.hasBounds = true;
+            asset.importMs = asset.imported->importMs;
+            asset.lod.SetBounds(asset.boundsMin, asset.boundsMax);
+            asset.textures.resize(asset.imported->textures.size());
+            asset.streamedTextures.assign(asset.imported->textures.size(), -1);
+            asset.textureLayers.resize(asset.imported->textures.size());
+            asset.meshes.reserve(asset.imported->meshes.size());
+            uploading.push_back(item.first);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        while (!uploading.empty()) {
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= budgetMs)
+                break;
+
+            ModelAsset &asset = *models[uploading.front()];
+            auto stepStart = std::chrono::steady_clock::now();
+            bool done = UploadStep(asset);
+            asset.uploadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stepStart).count();
+            if (done) {
+                asset.imported.reset();
+                asset.state = AssetState::Resident;
+                ReportLods(asset);
+                uploading.pop_front();
+            }
+        }
+    }
+
+    // crta ucitane mreze; dok model nije ucitan do kraja crta i bounding box
+    void Draw(ModelHandle handle, Shader &shader, int level) {
+        ModelAsset &asset = *models[handle];
+        asset.lod.Draw(shader, level);
+    }
+
+    void DrawPlaceholder(ModelHandle handle, Shader &placeholderShader, const glm::mat4 &model) {
+        ModelAsset &asset = *models[handle];
+        // model koji nije uspeo da se ucita se ne crta (stanje se vidi u listi modela)
+        if (asset.state == AssetState::Resident || asset.state == AssetState::Failed)
+            return;
+
+        if (boxVAO.Id() == 0)
+            CreateBox();
+        glm::mat4 boxModel = glm::translate(model, 0.5f * (asset.boundsMin + asset.boundsMax));
+        boxModel = glm::scale(boxModel, asset.boundsMax - asset.boundsMin);
+
+        placeholderShader.use();
+        placeholderShader.setMat4("model", boxModel);
+        placeholderShader.setFloat("progress", asset.Progress());
+        glBindVertexArray(boxVAO);
+        glDrawElements(GL_LINES, 24, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+    }
+
+private:
+    std::vector<std::unique_ptr<ModelAsset>> models;
+    std::deque<ModelHandle> uploading;
+    TextureArrayManager *textureArrays = nullptr;
+    TextureStreamer *streamer = nullptr;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::pair<ModelHandle, ModelAsset *>> importQueue;
+    std::vector<std::pair<ModelHandle, std::unique_ptr<ImportedModel>>> imported;
+    bool stopping = false;
+
+    GlVertexArray boxVAO;
+    GlBuffer boxVBO, boxEBO;
+
+    // koliko bajtova teksture, odnosno bafera mreze, se salje u jednom koraku
+    static const int textureChunkBytes = 256 * 1024;
+    static const int meshChunkBytes = 256 * 1024;
+
+    void WorkerLoop() {
+        Tracer::Get().SetThreadName("asset worker");
+        while (true) {
+            ModelHandle handle;
+            ModelAsset *asset;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !importQueue.empty(); });
+                if (stopping)
+                    return;
+                handle = importQueue.front().first;
+                asset = importQueue.front().second;
+                importQueue.pop_front();
+            }
+
+            asset->state = AssetState::Importing;
+            TraceZone zone(Tracer::Get().Enabled() ? Tracer::Get().Intern("Import " + asset->path) : "Import", "asset");
+            auto start = std::chrono::steady_clock::now();
+            std::unique_ptr<ImportedModel> result(new ImportedModel);
+            bool ok = assets::ImportModel(asset->path, *result, !streamer || textureArrays);
+
+            if (!ok) {
+                asset->state = AssetState::Failed;
+                continue;
+            }
+            if (textureArrays)
+                PrepareLayers(*result);
+            if (streamer)
+                PrepareStreaming(*result);
+            result->importMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            asset->state = AssetState::Uploading;
+            std::lock_guard<std::mutex> lock(mutex);
+            imported.emplace_back(handle, std::move(result));
+        }
+    }
+
+    // radna nit: skaliranje i prosirenje na RGBA8, da render nit samo kopira redove u sloj
+    void PrepareLayers(ImportedModel &model) {
+        TraceZone zone("Resample texture layers", "asset");
+        for (ImportedTexture &texture : model.textures) {
+            if (!texture.data)
+                continue;
+            textureArrays->LayerSize(texture.width, texture.height, texture.layerWidth, texture.layerHeight);
+            texture.layerPixels = ResampleRgba(texture.data, texture.width, texture.height, texture.components,
+                                               texture.layerWidth, texture.layerHeight);
+            model.layerCount++;
+        }
+    }
+
+    // radna nit: kes mipmapa na disku (pravi se pri prvom ucitavanju) i rep lanca za registraciju
+    void PrepareStreaming(ImportedModel &model) {
+        for (ImportedTexture &texture : model.textures)
+            streaming::PrepareSource(texture.path, streamer->tailSize, streamer->cacheDirectory, texture.stream);
+    }
+
+    // jedan korak otpremanja: deo redova teksture ili sloja niza, ili deo bafera mreze; vraca true kada je model gotov
+    bool UploadStep(ModelAsset &asset) {
+        ImportedModel &source = *asset.imported;
+
+        if (asset.nextTexture < source.textures.size()) {
+            ImportedTexture &texture = source.textures[asset.nextTexture];
+            if (streamer)
+                RegisterStreamed(asset, texture);
+            else
+                UploadTextureRows(asset, texture);
+            return false;
+        }
+
+        if (textureArrays && asset.nextLayer < source.textures.size()) {
+            ImportedTexture &texture = source.textures[asset.nextLayer];
+            UploadLayerRows(asset, texture);
+            return false;
+        }
+
+        if (asset.nextMesh < source.meshes.size()) {
+            UploadMeshChunk(asset, source);
+            return false;
+        }
+
+        if (textureArrays)
+            textureArrays->GenerateMipmaps();
+        return true;
+    }
+
+    // Mreza se salje po opsezima bafera (glBufferSubData): prvo temena, pa indeksi svih LOD
+    // nivoa u jednom EBO-u (nivo 0 je na pocetku, pa Mesh::Draw crta pun model). Mesh objekat
+    // se pravi tek kada je sve poslato; njegov konstruktor odmah salje geometriju, pa dobija
+    // samo jedno teme, a njegov VAO i baferi se brisu i zamenjuju otpremljenim.
+    void UploadMeshChunk(ModelAsset &asset, ImportedModel &source) {
+        ImportedMesh &imported = source.meshes[asset.nextMesh];
+        size_t vertexBytes = imported.vertices.size() * sizeof(Vertex);
+        size_t indexBytes = imported.lods.indices.size() * sizeof(unsigned int);
+
+        if (asset.meshVAO.Id() == 0) {
+            asset.meshVAO = GlVertexArray::Create(asset.path + " VAO");
+            asset.meshVBO = GlBuffer::Create(asset.path + " VBO");
+            asset.meshEBO = GlBuffer::Create(asset.path + " LOD indices");
+            glBindVertexArray(asset.meshVAO);
+            GlBufferData(asset.meshVBO, GL_ARRAY_BUFFER, vertexBytes, NULL, GL_STATIC_DRAW);
+            GlBufferData(asset.meshEBO, GL_ELEMENT_ARRAY_BUFFER, indexBytes, NULL, GL_STATIC_DRAW);
+            // isti raspored atributa kao u Mesh::setupMesh
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Position));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Normal));
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, TexCoords));
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Tangent));
+            glEnableVertexAttribArray(4);
+            glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Bitangent));
+            glBindVertexArray(0);
+        }
+
+        // jedan opseg jednog bafera po koraku; GL_COPY_WRITE_BUFFER da se ne dira VAO
+        if (asset.nextMeshByte < vertexBytes) {
+            size_t bytes = std::min((size_t) meshChunkBytes, vertexBytes - asset.nextMeshByte);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, asset.meshVBO);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr) asset.nextMeshByte, (GLsizeiptr) bytes,
+                            (const char *) imported.vertices.data() + asset.nextMeshByte);
+            asset.nextMeshByte += bytes;
+        } else if (asset.nextMeshByte < vertexBytes + indexBytes) {
+            size_t offset = asset.nextMeshByte - vertexBytes;
+            size_t bytes = std::min((size_t) meshChunkBytes, indexBytes - offset);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, asset.meshEBO);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr) offset, (GLsizeiptr) bytes,
+                            (const char *) imported.lods.indices.data() + offset);
+            asset.nextMeshByte += bytes;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (asset.nextMeshByte < vertexBytes + indexBytes)
+            return;
+
+        std::vector<Texture> textures;
+        for (unsigned int index : imported.textures) {
+            Texture texture;
+            texture.id = streamer ? streamer->TextureId(asset.streamedTextures[index]) : asset.textures[index].Id();
+            texture.type = source.textures[index].type;
+            texture.path = source.textures[index].path;
+            textures.push_back(texture);
+        }
+
+        asset.meshes.push_back(Mesh(std::vector<Vertex>(1), std::vector<unsigned int>(1, 0), textures));
+        Mesh &mesh = asset.meshes.back();
+        mesh.glslIdentifierPrefix = asset.texturePrefix;
+
+        // Mesh ne brise svoje bafere; citaju se iz njegovog VAO-a
+        GLint vbo = 0, ebo = 0;
+        glBindVertexArray(mesh.VAO);
+        glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vbo);
+        glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &ebo);
+        glBindVertexArray(0);
+        unsigned int buffers[2] = {(unsigned int) vbo, (unsigned int) ebo};
+        glDeleteBuffers(2, buffers);
+        glDeleteVertexArrays(1, &mesh.VAO);
+
+        mesh.VAO = asset.meshVAO;
+        mesh.vertices = std::move(imported.vertices);
+        mesh.indices = std::move(imported.indices);
+        asset.meshTextures.push_back(imported.textures);
+        asset.meshArrays.push_back(std::move(asset.meshVAO));
+        asset.meshBuffers.push_back(std::move(asset.meshVBO));
+
+        MeshLods lods;
+        lods.EBO = std::move(asset.meshEBO);
+        lods.levels = imported.lods.levels;
+        asset.lod.AddMesh(std::move(lods));
+        asset.lodData.push_back(std::move(imported.lods));
+
+        asset.nextMesh++;
+        asset.nextMeshByte = 0;
+    }
+
+    // provera da pojednostavljivanje zaista smanjuje model (broj trouglova po nivou)
+    static void ReportLods(const ModelAsset &asset) {
+        const LodModel &lod = asset.lod;
+        std::cout << "LOD " << asset.path << ":";
+        for (unsigned int triangles : lod.levelTriangles)
+            std::cout << " " << triangles;
+        std::cout << " triangles" << std::endl;
+        if (lod.LevelCount() < 2 || lod.levelTriangles[1] >= lod.levelTriangles[0])
+            std::cout << "WARNING::LOD:: " << asset.path << " has no simplified level" << std::endl;
+    }
+
+    // teksture se alociraju pa pune po redovima (glTexSubImage2D), mipmape na kraju
+    void UploadTextureRows(ModelAsset &asset, ImportedTexture &texture) {
+        if (!texture.data) {
+            asset.nextTexture++;
+            return;
+        }
+
+        GLenum format = GL_RGB;
+        if (texture.components == 1)
+            format = GL_RED;
+        else if (texture.components == 3)
+            format = GL_RGB;
+        else if (texture.components == 4)
+            format = GL_RGBA;
+
+        GlTexture &id = asset.textures[asset.nextTexture];
+        if (asset.nextTextureRow == 0) {
+            id = GlTexture::Create(texture.path);
+            id.SetBytes(EstimateTextureBytes(format, texture.width, texture.height, 1, true));
+            glBindTexture(GL_TEXTURE_2D, id);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, texture.width, texture.height, 0, format, GL_UNSIGNED_BYTE, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+
+        int rowBytes = texture.width * texture.components;
+        int rows = std::max(1, textureChunkBytes / std::max(rowBytes, 1));
+        rows = std::min(rows, texture.height - asset.nextTextureRow);
+
+        glBindTexture(GL_TEXTURE_2D, id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, asset.nextTextureRow, texture.width, rows, format, GL_UNSIGNED_BYTE,
+                        texture.data + (size_t) asset.nextTextureRow * rowBytes);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        asset.nextTextureRow += rows;
+
+        if (asset.nextTextureRow >= texture.height) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            stbi_image_free(texture.data);
+            texture.data = nullptr;
+            asset.nextTextureRow = 0;
+            asset.nextTexture++;
+        }
+    }
+
+    // na GPU ide samo rep lanca; detaljnije nivoe ucitava TextureStreamer po potrebi
+    void RegisterStreamed(ModelAsset &asset, ImportedTexture &texture) {
+        asset.streamedTextures[asset.nextTexture] = streamer->Register(std::move(texture.stream), false, false);
+        stbi_image_free(texture.data);
+        texture.data = nullptr;
+        asset.nextTexture++;
+    }
+
+    // sloj niza se puni po redovima kao i obicna tekstura; mipmape stranice na kraju modela
+    void UploadLayerRows(ModelAsset &asset, ImportedTexture &texture) {
+        if (texture.layerPixels.empty()) {
+            asset.nextLayer++;
+            return;
+        }
+
+        TextureLayer &layer = asset.textureLayers[asset.nextLayer];
+        if (asset.nextLayerRow == 0)
+            layer = textureArrays->Allocate(texture.layerWidth, texture.layerHeight);
+
+        int rowBytes = texture.layerWidth * 4;
+        int rows = std::max(1, textureChunkBytes / rowBytes);
+        rows = std::min(rows, texture.layerHeight - asset.nextLayerRow);
+        textureArrays->UploadRows(layer, asset.nextLayerRow, rows,
+                                  texture.layerPixels.data() + (size_t) asset.nextLayerRow * rowBytes);
+        asset.nextLayerRow += rows;
+
+        if (asset.nextLayerRow >= texture.layerHeight) {
+            std::vector<unsigned char>().swap(texture.layerPixels);
+            asset.nextLayerRow = 0;
+            asset.nextLayer++;
+        }
+    }
+
+    void CreateBox() {
+        float vertices[] = {
+                -0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f, 0.5f, -0.5f,   -0.5f, 0.5f, -0.5f,
+                -0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f, 0.5f,  0.5f,   -0.5f, 0.5f,  0.5f
+        };
+        unsigned int indices[] = {
+                0, 1, 1, 2, 2, 3, 3, 0,
+                4, 5, 5, 6, 6, 7, 7, 4,
+                0, 4, 1, 5, 2, 6, 3, 7
+        };
+        boxVAO = GlVertexArray::Create("placeholder box VAO");
+        boxVBO = GlBuffer::Create("placeholder box VBO");
+        boxEBO = GlBuffer::Create("placeholder box EBO");
+        glBindVertexArray(boxVAO);
+        GlBufferData(boxVBO, GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        GlBufferData(boxEBO, GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glBindVertexArray(0);
+    }
+};
+
+#endif
@@ -0,0 +1,514 @@
+#ifndef BATCH_RENDER_H
+#define BATCH_RENDER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <gl_resources.h>
+#include <trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Paketno renderovanje pregleda scene iz vise pozicija kamere.
+//
+// Pozicije se citaju iz tekstualnog fajla, jedna po liniji: ime pa parovi kljuc=vrednost
+// (nenavedeni kljucevi imaju podrazumevane vrednosti, target zamenjuje yaw/pitch, # je komentar):
+//
+//     front  position=-1,0,3 target=1,0,1 fov=45 exposure=0.9 bloom=1 attack=0
+//     top    position=1,25,2 yaw=-90 pitch=-80
+//
+// Sve pozicije se renderuju jedna za drugom u istom (skrivenom) prozoru, pa se modeli, teksture
+// i ostali GL resursi ucitavaju samo jednom. Zavrsna slika (tonemap) se crta pravo u polje
+// atlasa na GPU; kada se atlas popuni, cita se u PBO, a posle fence-a se predaje radnoj niti
+// koja pise PPM fajl. Render nit tako ne ceka ni GPU ni disk.
+
+struct BatchPose {
+    std::string name;
+    glm::vec3 position = glm::vec3(-1.0f, 0.0f, 3.0f);
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+    float fov = 45.0f;
+    float exposure = 0.9f;
+    bool bloom = true;
+    bool attack = false;
+};
+
+struct BatchOptions {
+    bool enabled = false;
+    std::string posesPath;
+    std::string outputDirectory = "batch_output/";
+    int columns = 1;
+    int rows = 1;
+    int tileWidth = 0;      // 0: velicina prozora
+    int tileHeight = 0;
+    int settleFrames = 0;   // dodatni frejmovi po poziciji (npr. da se dostrimuju teksture)
+};
+
+namespace batch {
+
+inline bool ParseVec3(const std::string &text, glm::vec3 &out) {
+    return std::sscanf(text.c_str(), "%f,%f,%f", &out.x, &out.y, &out.z) == 3;
+}
+
+inline bool ParseSize(const std::string &text, int &width, int &height) {
+    return std::sscanf(text.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+// yaw i pitch (u stepenima, kao Camera) za pogled od position ka target
+inline void LookAt(BatchPose &pose, const glm::vec3 &target) {
+    glm::vec3 direction = target - pose.position;
+    float length = glm::length(direction);
+    if (length < 1e-6f)
+        return;
+    pose.yaw = glm::degrees(std::atan2(direction.z, direction.x));
+    pose.pitch = glm::clamp(glm::degrees(std::asin(direction.y / length)), -89.0f, 89.0f);
+}
+
+inline bool LoadPoses(const std::string &path, std::vector<BatchPose> &poses, std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        BatchPose pose;
+        if (!(tokens >> pose.name))
+            continue;
+
+        std::string token;
+        glm::vec3 target;
+        bool hasTarget = false;
+        while (tokens >> token) {
+            size_t separator = token.find('=');
+            std::string key = token.substr(0, separator);
+            std::string value = separator == std::string::npos ? "" : token.substr(separator + 1);
+            bool ok = true;
+            if (key == "position")
+                ok = ParseVec3(value, pose.position);
+            else if (key == "target")
+                ok = hasTarget = ParseVec3(value, target);
+            else if (key == "yaw")
+                pose.yaw = (float) std::atof(value.c_str());
+            else if (key == "pitch")
+                pose.pitch = glm::clamp((float) std::atof(value.c_str()), -89.0f, 89.0f);
+            else if (key == "fov")
+                pose.fov = glm::clamp((float) std::atof(value.c_str()), 1.0f, 45.0f);
+            else if (key == "exposure")
+                pose.exposure = (float) std::atof(value.c_str());
+            else if (key == "bloom")
+                pose.bloom = std::atoi(value.c_str()) != 0;
+            else if (key == "attack")
+                pose.attack = std::atoi(value.c_str()) != 0;
+            else
+                ok = false;
+            if (!ok || value.empty()) {
+                error = path + ":" + std::to_string(lineNumber) + ": invalid '" + token + "'";
+                return false;
+            }
+        }
+        if (hasTarget)
+            LookAt(pose, target);
+        poses.push_back(pose);
+    }
+    if (poses.empty()) {
+        error = path + ": no poses";
+        return false;
+    }
+    return true;
+}
+
+// --batch <fajl> [--out <dir>] [--atlas <kolone>x<redovi>] [--tile <sirina>x<visina>] [--settle <frejmovi>];
+// false ako nekom argumentu nedostaje vrednost
+inline bool ParseOptions(int argc, char **argv, BatchOptions &options, std::string &error) {
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            error = "missing value for " + flag;
+            return false;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--batch") {
+            options.posesPath = value;
+            options.enabled = true;
+        } else if (flag == "--out") {
+            // prazan --out: tekuci direktorijum
+            options.outputDirectory = value.empty() ? "./" : value.back() == '/' ? value : value + "/";
+        } else if (flag == "--atlas") {
+            if (!ParseSize(value, options.columns, options.rows))
+                std::cout << "Invalid --atlas " << value << ", expected <columns>x<rows>" << std::endl;
+        } else if (flag == "--tile") {
+            if (!ParseSize(value, options.tileWidth, options.tileHeight))
+                std::cout << "Invalid --tile " << value << ", expected <width>x<height>" << std::endl;
+        } else if (flag == "--settle") {
+            options.settleFrames = std::max(0, std::atoi(value.c_str()));
+        } else {
+            std::cout << "Unknown argument " << flag << std::endl;
+        }
+    }
+    return true;
+}
+
+inline void MakeDirectory(const std::string &path) {
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+} // namespace batch
+
+// radna nit koja pise slike (RGBA8, redovi odozdo kao iz glReadPixels) kao binarni PPM,
+// a za atlas i tekstualni indeks polja
+class AsyncImageWriter {
+public:
+    static const int maxQueued = 8;
+
+    struct Image {
+        std::string path;
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+        int columns = 1;
+        std::vector<std::string> tileNames;     // prazno: pojedinacna slika bez indeksa
+    };
+
+    AsyncImageWriter() {
+        worker = std::thread(&AsyncImageWriter::WorkerLoop, this);
+    }
+
+    ~AsyncImageWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        worker.join();
+    }
+
+    // blokira samo ako u redu vec ceka maxQueued slika
+    void Write(Image &&image) {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this] { return (int) queue.size() < maxQueued; });
+        queue.push_back(std::move(image));
+        condition.notify_one();
+    }
+
+    void Flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this] { return queue.empty() && !writing; });
+    }
+
+    unsigned int Written() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written;
+    }
+
+    double WriteMs() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return writeMs;
+    }
+
+private:
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::condition_variable drained;
+    std::deque<Image> queue;
+    bool writing = false;
+    bool stopping = false;
+    unsigned int written = 0;
+    double writeMs = 0.0;
+
+    void WorkerLoop() {
+        Tracer::Get().SetThreadName("image writer");
+        while (true) {
+            Image image;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                image = std::move(queue.front());
+                queue.pop_front();
+                writing = true;
+            }
+            drained.notify_all();
+
+            TraceZone zone("Write image", "batch");
+            auto start = std::chrono::steady_clock::now();
+            bool ok = WritePpm(image) && WriteIndex(image);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (!ok)
+                std::cout << "Batch image could not be written: " << image.path << std::endl;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                writing = false;
+                written += ok;
+                writeMs += ms;
+            }
+            drained.notify_all();
+        }
+    }
+
+    static bool WritePpm(const Image &image) {
+        std::ofstream out(image.path, std::ios::binary);
+        out << "P6\n" << image.width << " " << image.height << "\n255\n";
+        std::vector<unsigned char> row(image.width * 3);
+        for (int y = image.height - 1; y >= 0; y--) {
+            const unsigned char *source = image.pixels.data() + (size_t) y * image.width * 4;
+            for (int x = 0; x < image.width; x++) {
+                row[x * 3 + 0] = source[x * 4 + 0];
+                row[x * 3 + 1] = source[x * 4 + 1];
+                row[x * 3 + 2] = source[x * 4 + 2];
+            }
+            out.write((const char *) row.data(), row.size());
+        }
+        return (bool) out;
+    }
+
+    // indeks atlasa: polje -> ime pozicije
+    static bool WriteIndex(const Image &image) {
+        if (image.tileNames.empty())
+            return true;
+        std::ofstream index(image.path.substr(0, image.path.size() - 4) + ".txt");
+        for (size_t i = 0; i < image.tileNames.size(); i++)
+            index << i % image.columns << " " << i / image.columns << " " << image.tileNames[i] << '\n';
+        return (bool) index;
+    }
+};
+
+class BatchRenderer {
+public:
+    static const int readbackSlots = 3;
+    static const int maxWarmupFrames = 600;
+
+    BatchRenderer(const BatchOptions &batchOptions, std::vector<BatchPose> batchPoses, int windowWidth, int windowHeight)
+            : options(batchOptions), poses(std::move(batchPoses)) {
+        tileWidth = options.tileWidth > 0 ? options.tileWidth : windowWidth;
+        tileHeight = options.tileHeight > 0 ? options.tileHeight : windowHeight;
+        columns = std::max(1, options.columns);
+        rows = std::max(1, options.rows);
+        width = tileWidth * columns;
+        height = tileHeight * rows;
+        batch::MakeDirectory(options.outputDirectory);
+
+        atlasTexture = GlTexture::Create("batch atlas");
+        atlasTexture.SetBytes(EstimateTextureBytes(GL_RGBA8, width, height, 1, false));
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        atlasFBO = GlFramebuffer::Create("batch atlas FBO");
+        glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlasTexture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Batch atlas framebuffer not complete!" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        for (int i = 0; i < readbackSlots; i++) {
+            slots[i].buffer = GlBuffer::Create("batch readback " + std::to_string(i));
+            GlBufferData(slots[i].buffer, GL_PIXEL_PACK_BUFFER, (size_t) width * height * 4, NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    ~BatchRenderer() {
+        for (Slot &slot : slots)
+            if (slot.fence)
+                glDeleteSync(slot.fence);
+    }
+
+    bool Done() const {
+        return next >= (int) poses.size();
+    }
+
+    // pozicija koja se renderuje u ovom frejmu (i u frejmovima zagrevanja)
+    const BatchPose &Current() const {
+        return poses[std::min(next, (int) poses.size() - 1)];
+    }
+
+    // umesto podrazumevanog framebuffer-a: polje atlasa za tekucu poziciju
+    void BindTarget() {
+        int tile = next % (columns * rows);
+        int column = tile % columns, row = tile / columns;
+        glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+        // nova strana: polja prethodne strane se brisu, da ih poslednji (nepun) atlas ne bi sadrzao;
+        // citanje prethodne strane je vec poslato, a GL cuva redosled
+        if (tile == 0) {
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        glViewport(column * tileWidth, (rows - 1 - row) * tileHeight, tileWidth, tileHeight);
+    }
+
+    // posle zavrsne slike; ready: svi modeli i teksture su ucitani (do tada se samo zagreva)
+    void EndFrame(bool ready) {
+        TraceZone zone("Batch", "batch");
+        Poll(false);
+        if (!started) {
+            if (!ready && ++warmupFrames < maxWarmupFrames)
+                return;
+            if (!ready)
+                std::cout << "Batch: assets not ready after " << maxWarmupFrames << " frames, rendering anyway" << std::endl;
+            started = true;
+            start = std::chrono::steady_clock::now();
+            return;
+        }
+        if (poseFrames++ < options.settleFrames)
+            return;
+        poseFrames = 0;
+        frames++;
+        next++;
+        int tiles = next % (columns * rows);
+        if (tiles == 0 || Done())
+            Readback(tiles == 0 ? columns * rows : tiles);
+        if (Done())
+            renderMs = Elapsed();
+    }
+
+    // ceka sve citanja i upise; ispisuje propusnost
+    void Finish() {
+        Poll(true);
+        writer.Flush();
+        double totalMs = Elapsed();
+        std::cout << "Batch: " << poses.size() << " images (" << pages << " files, " << tileWidth << "x" << tileHeight
+                  << " tiles) in " << totalMs / 1000.0 << " s: " << poses.size() * 1000.0 / std::max(totalMs, 1e-3)
+                  << " images/s (" << poses.size() * 1000.0 / std::max(renderMs, 1e-3) << " images/s rendered, "
+                  << frames << " frames, warmup " << warmupFrames << " frames, readback wait "
+                  << readbackWaitMs << " ms, writer " << writer.WriteMs() << " ms)" << std::endl;
+        if (failedPages > 0)
+            std::cout << "Batch: " << failedPages << " files lost (fence wait failed)" << std::endl;
+    }
+
+private:
+    struct Slot {
+        GlBuffer buffer;
+        GLsync fence = nullptr;
+        std::string path;
+        std::vector<std::string> names;
+    };
+
+    BatchOptions options;
+    std::vector<BatchPose> poses;
+    int tileWidth, tileHeight, columns, rows, width, height;
+    GlTexture atlasTexture;
+    GlFramebuffer atlasFBO;
+    Slot slots[readbackSlots];
+    int oldest = 0;
+    int inFlight = 0;
+    AsyncImageWriter writer;
+
+    int next = 0;
+    int poseFrames = 0;
+    int warmupFrames = 0;
+    unsigned int frames = 0;
+    unsigned int pages = 0;
+    unsigned int failedPages = 0;
+    bool started = false;
+    std::chrono::steady_clock::time_point start;
+    double renderMs = 0.0;
+    double readbackWaitMs = 0.0;
+
+    double Elapsed() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // atlas (ili pojedinacna slika) u PBO; sledeca pozicija odmah crta preko, GL cuva redosled
+    void Readback(int tiles) {
+        if (inFlight == readbackSlots)
+            Complete(true);
+        Slot &slot = slots[(oldest + inFlight) % readbackSlots];
+        int first = next - tiles;
+        slot.names.clear();
+        for (int i = first; i < next; i++)
+            slot.names.push_back(poses[i].name);
+        char name[32];
+        std::snprintf(name, sizeof(name), "atlas_%03u.ppm", pages);
+        slot.path = options.outputDirectory + (columns * rows == 1 ? poses[first].name + ".ppm" : std::string(name));
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, atlasFBO);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        inFlight++;
+        pages++;
+    }
+
+    void Poll(bool wait) {
+        while (inFlight > 0 && Complete(wait)) {
+        }
+    }
+
+    // najstarije citanje: kopija iz PBO i predaja radnoj niti; false ako GPU jos nije gotov (samo bez cekanja).
+    // Sa cekanjem se ceka dok fence ne bude signaliziran, koliko god trajalo (spor ili softverski GL).
+    bool Complete(bool wait) {
+        Slot &slot = slots[oldest];
+        auto waitStart = std::chrono::steady_clock::now();
+        GLenum result = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+        while (wait && result == GL_TIMEOUT_EXPIRED)
+            result = glClientWaitSync(slot.fence, 0, 1000000000ull);
+        readbackWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+        if (result == GL_TIMEOUT_EXPIRED)
+            return false;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        if (result == GL_WAIT_FAILED) {
+            // sadrzaj PBO nije pouzdan; slot se oslobadja da prsten ostane ispravan
+            std::cout << "Batch: fence wait failed, " << slot.path << " not written" << std::endl;
+            failedPages++;
+            oldest = (oldest + 1) % readbackSlots;
+            inFlight--;
+            return true;
+        }
+
+        AsyncImageWriter::Image image;
+        image.path = slot.path;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize((size_t) width * height * 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, image.pixels.size(), GL_MAP_READ_BIT);
+        if (data)
+            std::memcpy(image.pixels.data(), data, image.pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if (columns * rows > 1) {
+            image.columns = columns;
+            image.tileNames = std::move(slot.names);
+        }
+        writer.Write(std::move(image));
+        oldest = (oldest + 1) % readbackSlots;
+        inFlight--;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <glm/glm.hpp>
+
+// Frustum iz projection * view matrice (Gribb & Hartmann), za odsecanje objekata van kamere.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    explicit Frustum(const glm::mat4 &viewProjection) {
+        const glm::mat4 &m = viewProjection;
+        for (int i = 0; i < 3; i++) {
+            glm::vec4 row = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+            glm::vec4 w = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+            planes[i * 2 + 0] = w + row;
+            planes[i * 2 + 1] = w - row;
+        }
+        for (glm::vec4 &plane : planes)
+            plane = plane / glm::length(glm::vec3(plane));
+    }
+
+    bool TestSphere(const glm::vec3 &center, float radius) const {
+        for (const glm::vec4 &plane : planes)
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                return false;
+        return true;
+    }
+
+    bool TestAabb(const glm::vec3 &minP, const glm::vec3 &maxP) const {
+        for (const glm::vec4 &plane : planes) {
+            glm::vec3 n = glm::vec3(plane);
+            glm::vec3 p(n.x >= 0.0f ? maxP.x : minP.x, n.y >= 0.0f ? maxP.y : minP.y, n.z >= 0.0f ? maxP.z : minP.z);
+            if (glm::dot(n, p) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
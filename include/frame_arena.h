@@ -0,0 +1,168 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Linearni (bump) alokator za podatke koji zive jedan frejm: liste za crtanje,
+// rezultati odsecanja, privremeni stringovi. Reset() na pocetku frejma samo vraca
+// pokazivac na pocetak; oslobadjanje pojedinacnih alokacija ne postoji.
+//
+// Ako frejm potrosi vise od kapaciteta, dodaju se novi blokovi, a pri sledecem Reset()
+// se sve spaja u jedan veci blok. U ustaljenom stanju arena ne poziva malloc.
+
+class FrameArena {
+public:
+    explicit FrameArena(size_t initialCapacity = 256 * 1024) {
+        AddBlock(initialCapacity);
+    }
+
+    ~FrameArena() {
+        for (Block &block : blocks)
+            std::free(block.data);
+    }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        Block *block = &blocks.back();
+        size_t offset = (block->used + alignment - 1) & ~(alignment - 1);
+        if (offset + bytes > block->size) {
+            AddBlock(std::max(bytes + alignment, block->size * 2));
+            block = &blocks.back();
+            offset = (block->used + alignment - 1) & ~(alignment - 1);
+        }
+        block->used = offset + bytes;
+        used += bytes;
+        return block->data + offset;
+    }
+
+    template<typename T>
+    T *Allocate(size_t count) {
+        return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // poziva se jednom po frejmu (na niti koja je vlasnik arene)
+    void Reset() {
+        highWater = std::max(highWater, used);
+        lastFrameUsed = used;
+        used = 0;
+
+        if (blocks.size() > 1) {
+            size_t capacity = 0;
+            for (Block &block : blocks) {
+                capacity += block.size;
+                std::free(block.data);
+            }
+            blocks.clear();
+            AddBlock(capacity);
+        }
+        blocks.back().used = 0;
+    }
+
+    size_t Used() const { return used; }
+    size_t LastFrameUsed() const { return lastFrameUsed; }
+    size_t HighWater() const { return std::max(highWater, used); }
+    size_t BlockCount() const { return blocks.size(); }
+
+    size_t Capacity() const {
+        size_t capacity = 0;
+        for (const Block &block : blocks)
+            capacity += block.size;
+        return capacity;
+    }
+
+    // printf u arenu; string vazi do kraja frejma
+    const char *Format(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        va_list copy;
+        va_copy(copy, args);
+        int length = std::vsnprintf(nullptr, 0, format, copy);
+        va_end(copy);
+
+        char *text = Allocate<char>(length + 1);
+        std::vsnprintf(text, length + 1, format, args);
+        va_end(args);
+        return text;
+    }
+
+private:
+    struct Block {
+        char *data;
+        size_t size;
+        size_t used;
+    };
+
+    std::vector<Block> blocks;
+    size_t used = 0;
+    size_t lastFrameUsed = 0;
+    size_t highWater = 0;
+
+    void AddBlock(size_t size) {
+        char *data = static_cast<char *>(std::malloc(size));
+        if (!data)
+            throw std::bad_alloc();
+        blocks.push_back({data, size, 0});
+    }
+};
+
+// arena za tekucu nit: glavna nit je resetuje na pocetku frejma, radne niti na pocetku posla
+inline FrameArena &ThreadFrameArena() {
+    thread_local FrameArena arena;
+    return arena;
+}
+
+// STL alokator nad arenom; deallocate ne radi nista
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    FrameArena *arena;
+
+    ArenaAllocator() : arena(&ThreadFrameArena()) {}
+
+    explicit ArenaAllocator(FrameArena &arena) : arena(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        return arena->Allocate<T>(n);
+    }
+
+    void deallocate(T *, size_t) {}
+
+    template<typename U>
+    struct rebind {
+        typedef ArenaAllocator<U> other;
+    };
+};
+
+template<typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena == b.arena;
+}
+
+template<typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena != b.arena;
+}
+
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> FrameString;
+
+// broj poziva operator new iz niti pozivaoca od njenog pocetka (brojac je u allocation_counter.cpp)
+unsigned long long HeapAllocationCount();
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <gl_resources.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Ponovna upotreba frejma kada se nista ne menja.
+//
+// StateHash sazima stanje od kog zavisi slika (kamera, ProgramState, velicina...). Staticki
+// slojevi (podloge i skybox) se crtaju jednom u zaseban FBO (boja, svetla boja i dubina) i
+// svaki frejm samo kopiraju u hdrFBO, dok im se potpis ne promeni. IdleController posle
+// nekoliko mirnih frejmova prelazi u rezim mirovanja: frejmovi se proredjuju ili potpuno
+// preskacu (poslednja slika ostaje na ekranu) dok ne stigne ulaz ili promena stanja.
+
+class StateHash {
+public:
+    void Add(const void *data, size_t size) {
+        const unsigned char *bytes = (const unsigned char *) data;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    void Add(float value) { Add(&value, sizeof(value)); }
+    void Add(int value) { Add(&value, sizeof(value)); }
+    void Add(bool value) { Add((int) value); }
+    void Add(const glm::vec3 &value) { Add(value.x); Add(value.y); Add(value.z); }
+
+    void Add(const glm::mat4 &value) {
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                Add(value[column][row]);
+    }
+
+    uint64_t Value() const { return hash; }
+
+private:
+    uint64_t hash = 1469598103934665603ull;
+};
+
+enum class IdleMode {
+    Off,
+    Throttle,   // mirna scena se crta sa idleFps (animacije idu dalje)
+    Freeze      // mirna scena se ne crta, poslednja slika ostaje dok ne stigne dogadjaj
+};
+
+class IdleController {
+public:
+    // frejmovi bez promene pre mirovanja (istorija TAA i kontroler rezolucije se smire)
+    int settleFrames = 30;
+
+    unsigned long long renderedFrames = 0;
+    unsigned long long skippedFrames = 0;
+
+    // activity: ulaz, ucitavanje, napad, snimanje...; vraca true ako je scena mirna
+    bool Update(uint64_t signature, bool activity) {
+        if (activity || signature != lastSignature) {
+            quietFrames = 0;
+            lastSignature = signature;
+        } else if (quietFrames < settleFrames) {
+            quietFrames++;
+        }
+        return Idle();
+    }
+
+    bool Idle() const {
+        return quietFrames >= settleFrames;
+    }
+
+private:
+    uint64_t lastSignature = 0;
+    int quietFrames = 0;
+};
+
+// kopija statickih slojeva u formatima hdrFBO-a (2x RGBA16F + DEPTH24_STENCIL8), za direktan blit
+class StaticLayerCache {
+public:
+    unsigned long long hits = 0;
+    unsigned long long captures = 0;
+
+    StaticLayerCache(int width, int height)
+            : width(width), height(height) {
+        framebuffer = GlFramebuffer::Create("static layer FBO");
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        for (int i = 0; i < 2; i++) {
+            color[i] = GlTexture::Create(std::string("static layer color[") + char('0' + i) + "]");
+            color[i].SetBytes(EstimateTextureBytes(GL_RGBA16F, width, height));
+            glBindTexture(GL_TEXTURE_2D, color[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, color[i], 0);
+        }
+        depth = GlRenderbuffer::Create("static layer depth");
+        depth.SetBytes(EstimateTextureBytes(GL_DEPTH24_STENCIL8, width, height));
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+        glDrawBuffers(2, attachments);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Framebuffer not complete!" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    bool Matches(uint64_t signature) const {
+        return valid && signature == cachedSignature;
+    }
+
+    // posle poziva se crtaju staticki slojevi (u punoj rezoluciji), pa EndCapture
+    void BeginCapture(const glm::vec3 &clearColor) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, width, height);
+        glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    }
+
+    void EndCapture(uint64_t signature) {
+        cachedSignature = signature;
+        valid = true;
+        captures++;
+    }
+
+    void Invalidate() {
+        valid = false;
+    }
+
+    // kopija u targetFBO (boja u obe izlazne boje + dubina); posle poziva je vezan targetFBO
+    void Composite(unsigned int targetFBO) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFBO);
+        for (int i = 0; i < 2; i++) {
+            glReadBuffer(GL_COLOR_ATTACHMENT0 + i);
+            glDrawBuffer(GL_COLOR_ATTACHMENT0 + i);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height,
+                              i == 0 ? GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+        glDrawBuffers(2, attachments);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        hits++;
+    }
+
+private:
+    int width, height;
+    GlFramebuffer framebuffer;
+    GlTexture color[2];
+    GlRenderbuffer depth;
+    uint64_t cachedSignature = 0;
+    bool valid = false;
+    const unsigned int attachments[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+};
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+#include <glad/glad.h>
+
+#include <gl_resources.h>
+#include <trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Tempo frejmova za malo kasnjenje.
+//
+// FramePacer posle svakog swap-a ubacuje fence i GL_TIMESTAMP upit; pre novog frejma se
+// ceka dok na GPU ne ostane manje od zadatog broja frejmova, pa drajver ne moze da gomila
+// frejmove (i kasnjenje) u redu. Ulaz se tada cita tek posle cekanja. Kasnjenje od citanja
+// ulaza do prikaza se meri do trenutka kada GPU zavrsi frejm zajedno sa swap-om (vreme GPU
+// sata prevedeno u CPU sat); cekanje na vsync posle toga nije ukljuceno.
+//
+// FrameLimiter drzi zadati broj frejmova u sekundi: spava do malo pre roka, pa ostatak
+// vrti u petlji (sleep ume da zakasni i po nekoliko ms). Margina za vrtenje se prilagodjava
+// izmerenom kasnjenju sleep-a.
+
+class FramePacer {
+public:
+    static const int maxFrames = 8;
+    static const int historySize = 120;
+
+    float fenceWaitMs = 0.0f;
+    float latencyMs = 0.0f;         // poslednji zavrsen frejm
+    float averageLatencyMs = 0.0f;  // eksponencijalno usrednjeno
+    float history[historySize] = {};
+    int historyIndex = 0;
+
+    FramePacer() {
+        for (int i = 0; i < maxFrames; i++)
+            slots[i].query = GlQuery::Create("frame pacing timestamp " + std::to_string(i));
+    }
+
+    ~FramePacer() {
+        for (Slot &slot : slots)
+            if (slot.fence)
+                glDeleteSync(slot.fence);
+    }
+
+    // trenutak citanja ulaza za sledeci zavrsen frejm
+    void MarkInput() {
+        inputTime = Tracer::Now();
+    }
+
+    // obrada frejmova koje je GPU vec zavrsio (bez cekanja)
+    void Retire() {
+        while (inFlight > 0 && Signaled(slots[oldest], 0))
+            Complete();
+    }
+
+    // blokira dok na GPU ne bude manje od maxInFlight frejmova
+    void WaitForFrames(int maxInFlight) {
+        auto start = std::chrono::steady_clock::now();
+        Retire();
+        while (inFlight >= std::max(maxInFlight, 1)) {
+            Signaled(slots[oldest], 100000000ull);
+            Complete();
+        }
+        fenceWaitMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // odmah posle glfwSwapBuffers
+    void EndFrame() {
+        if (inFlight == maxFrames) {
+            Signaled(slots[oldest], 100000000ull);
+            Complete();
+        }
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuOffset = Tracer::Now() - (long long) gpuNow;
+
+        Slot &slot = slots[(oldest + inFlight) % maxFrames];
+        glQueryCounter(slot.query, GL_TIMESTAMP);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.inputTime = inputTime;
+        slot.gpuOffset = gpuOffset;
+        inFlight++;
+        glFlush();
+    }
+
+    int InFlight() const {
+        return inFlight;
+    }
+
+private:
+    struct Slot {
+        GlQuery query;
+        GLsync fence = nullptr;
+        long long inputTime = 0;
+        long long gpuOffset = 0;
+    };
+
+    Slot slots[maxFrames];
+    int oldest = 0;
+    int inFlight = 0;
+    long long inputTime = 0;
+    long long gpuOffset = 0;
+
+    static bool Signaled(const Slot &slot, GLuint64 timeout) {
+        GLenum result = glClientWaitSync(slot.fence, timeout > 0 ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+        return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+    }
+
+    // najstariji frejm je gotov: timestamp posle swap-a je dostupan
+    void Complete() {
+        Slot &slot = slots[oldest];
+        GLuint64 gpuTime = 0;
+        glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &gpuTime);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        oldest = (oldest + 1) % maxFrames;
+        inFlight--;
+
+        if (slot.inputTime == 0)
+            return;
+        latencyMs = std::max(0.0f, ((long long) gpuTime + slot.gpuOffset - slot.inputTime) / 1e6f);
+        averageLatencyMs = averageLatencyMs == 0.0f ? latencyMs : averageLatencyMs * 0.95f + latencyMs * 0.05f;
+        history[historyIndex] = latencyMs;
+        historyIndex = (historyIndex + 1) % historySize;
+        TraceCounter("Input-to-present latency (ms)", latencyMs);
+    }
+};
+
+class FrameLimiter {
+public:
+    float sleepMs = 0.0f;
+    float spinMs = 0.0f;
+    float spinMarginMs = 2.0f;
+    float missedMs = 0.0f;      // koliko je frejm zakasnio za rok (0 ako je limiter cekao)
+
+    void Wait(float fps) {
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point now = Clock::now();
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(fps, 1.0f)));
+        // zaostatak se ne nadoknadjuje nizom kratkih frejmova
+        next = next == Clock::time_point() ? now : next + period;
+        missedMs = now > next ? std::chrono::duration<float, std::milli>(now - next).count() : 0.0f;
+        if (next < now)
+            next = now;
+
+        Clock::time_point wakeAt = next - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(spinMarginMs));
+        sleepMs = 0.0f;
+        if (now < wakeAt) {
+            std::this_thread::sleep_until(wakeAt);
+            Clock::time_point woke = Clock::now();
+            sleepMs = std::chrono::duration<float, std::milli>(woke - now).count();
+            // margina odmah raste na najvece kasnjenje sleep-a (uz rezervu), a polako opada; [0.2, 4] ms
+            float overslept = std::chrono::duration<float, std::milli>(woke - wakeAt).count();
+            spinMarginMs = std::min(4.0f, std::max(0.2f, std::max(spinMarginMs * 0.99f, overslept * 1.5f)));
+            now = woke;
+        }
+
+        Clock::time_point spinStart = now;
+        while (Clock::now() < next) {
+#if defined(__SSE2__) || defined(_M_X64)
+            _mm_pause();
+#endif
+        }
+        spinMs = std::chrono::duration<float, std::milli>(Clock::now() - spinStart).count();
+    }
+
+    void Reset() {
+        next = std::chrono::steady_clock::time_point();
+    }
+
+private:
+    std::chrono::steady_clock::time_point next;
+};
+
+#endif
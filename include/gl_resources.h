@@ -0,0 +1,296 @@
+#ifndef GL_RESOURCES_H
+#define GL_RESOURCES_H
+
+#include <glad/glad.h>
+
+#include <frame_arena.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// RAII omotaci za OpenGL objekte. Svaki objekat se upisuje u centralni registar sa
+// procenjenom velicinom u bajtovima, tako da se zauzeta memorija na GPU moze pratiti
+// po tipu resursa, a na gasenju prijaviti sve sto nije oslobodjeno.
+
+enum class GlResourceType {
+    Buffer,
+    Texture,
+    Renderbuffer,
+    Framebuffer,
+    VertexArray,
+    Program,
+    Query,
+    Count
+};
+
+inline const char *GlResourceTypeName(GlResourceType type) {
+    switch (type) {
+        case GlResourceType::Buffer: return "Buffers";
+        case GlResourceType::Texture: return "Textures";
+        case GlResourceType::Renderbuffer: return "Renderbuffers";
+        case GlResourceType::Framebuffer: return "Framebuffers";
+        case GlResourceType::VertexArray: return "Vertex arrays";
+        case GlResourceType::Program: return "Programs";
+        case GlResourceType::Query: return "Queries";
+        case GlResourceType::Count: break;
+    }
+    return "";
+}
+
+struct GlResourceInfo {
+    std::string label;
+    size_t bytes;
+};
+
+class GlResourceRegistry {
+public:
+    static const int typeCount = (int) GlResourceType::Count;
+
+    static GlResourceRegistry &Get() {
+        static GlResourceRegistry registry;
+        return registry;
+    }
+
+    // prag upozorenja za ukupnu memoriju na GPU (0 = bez upozorenja); registar samo prati
+    // zauzece i nista ne odbija niti izbacuje (ogranicenje sa izbacivanjem ima TextureStreamer)
+    size_t warningBytes = 0;
+
+    void Register(GlResourceType type, unsigned int id, const std::string &label, size_t bytes = 0) {
+        Table(type)[id] = {label, bytes};
+        totals[(int) type] += bytes;
+        CheckThreshold();
+    }
+
+    void SetBytes(GlResourceType type, unsigned int id, size_t bytes) {
+        auto it = Table(type).find(id);
+        if (it == Table(type).end())
+            return;
+        totals[(int) type] -= it->second.bytes;
+        it->second.bytes = bytes;
+        totals[(int) type] += bytes;
+        CheckThreshold();
+    }
+
+    void Unregister(GlResourceType type, unsigned int id) {
+        auto it = Table(type).find(id);
+        if (it == Table(type).end())
+            return;
+        totals[(int) type] -= it->second.bytes;
+        Table(type).erase(it);
+    }
+
+    size_t Bytes(GlResourceType type) const {
+        return totals[(int) type];
+    }
+
+    size_t TotalBytes() const {
+        size_t sum = 0;
+        for (int i = 0; i < typeCount; i++)
+            sum += totals[i];
+        return sum;
+    }
+
+    size_t Count(GlResourceType type) const {
+        return tables[(int) type].size();
+    }
+
+    const std::map<unsigned int, GlResourceInfo> &Resources(GlResourceType type) const {
+        return tables[(int) type];
+    }
+
+    // najveci resursi (za prikaz u ImGui); lista je u areni frejma
+    FrameVector<std::pair<size_t, const std::string *>> Largest(size_t count) const {
+        FrameVector<std::pair<size_t, const std::string *>> all;
+        for (int i = 0; i < typeCount; i++)
+            for (const auto &entry : tables[i])
+                all.emplace_back(entry.second.bytes, &entry.second.label);
+        count = std::min(count, all.size());
+        std::partial_sort(all.begin(), all.begin() + count, all.end(),
+                          [](const std::pair<size_t, const std::string *> &a,
+                             const std::pair<size_t, const std::string *> &b) { return a.first > b.first; });
+        all.resize(count);
+        return all;
+    }
+
+    // poziva se na kraju, pre unistavanja konteksta: sve sto je jos registrovano nije oslobodjeno
+    size_t ReportLeaks(std::ostream &out) const {
+        size_t leaks = 0;
+        for (int i = 0; i < typeCount; i++) {
+            for (const auto &entry : tables[i]) {
+                out << "GL leak: " << GlResourceTypeName((GlResourceType) i) << " " << entry.first
+                    << " '" << entry.second.label << "' (" << entry.second.bytes << " bytes)" << std::endl;
+                leaks++;
+            }
+        }
+        if (leaks == 0)
+            out << "GL resources: no leaks" << std::endl;
+        return leaks;
+    }
+
+private:
+    std::map<unsigned int, GlResourceInfo> tables[typeCount];
+    size_t totals[typeCount] = {};
+    bool overThreshold = false;
+
+    std::map<unsigned int, GlResourceInfo> &Table(GlResourceType type) {
+        return tables[(int) type];
+    }
+
+    void CheckThreshold() {
+        bool over = warningBytes != 0 && TotalBytes() > warningBytes;
+        if (over && !overThreshold)
+            std::cout << "GL memory above warning threshold: " << TotalBytes() / (1024 * 1024) << " MB > "
+                      << warningBytes / (1024 * 1024) << " MB" << std::endl;
+        overThreshold = over;
+    }
+};
+
+// procena velicine teksture u bajtovima (sa mipmapama ~4/3)
+inline size_t EstimateTextureBytes(GLenum internalFormat, int width, int height, int layers = 1, bool mipmapped = false) {
+    size_t texel = 4;
+    switch (internalFormat) {
+        case GL_RED:
+        case GL_R8:
+            texel = 1; break;
+        case GL_RG8:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            texel = 2; break;
+        case GL_RGB:
+        case GL_RGB8:
+        case GL_SRGB:
+        case GL_SRGB8:
+            texel = 3; break;
+        case GL_RGB16F:
+            texel = 6; break;
+        case GL_RGBA16F:
+        case GL_RG32F:
+            texel = 8; break;
+        case GL_RGB32F:
+            texel = 12; break;
+        case GL_RGBA32F:
+            texel = 16; break;
+        default:
+            texel = 4; break;
+    }
+    size_t bytes = texel * (size_t) width * (size_t) height * (size_t) layers;
+    return mipmapped ? bytes * 4 / 3 : bytes;
+}
+
+namespace gl_resources {
+
+inline void Delete(GlResourceType type, unsigned int id) {
+    switch (type) {
+        case GlResourceType::Buffer: glDeleteBuffers(1, &id); break;
+        case GlResourceType::Texture: glDeleteTextures(1, &id); break;
+        case GlResourceType::Renderbuffer: glDeleteRenderbuffers(1, &id); break;
+        case GlResourceType::Framebuffer: glDeleteFramebuffers(1, &id); break;
+        case GlResourceType::VertexArray: glDeleteVertexArrays(1, &id); break;
+        case GlResourceType::Program: glDeleteProgram(id); break;
+        case GlResourceType::Query: glDeleteQueries(1, &id); break;
+        case GlResourceType::Count: break;
+    }
+}
+
+inline unsigned int Generate(GlResourceType type) {
+    unsigned int id = 0;
+    switch (type) {
+        case GlResourceType::Buffer: glGenBuffers(1, &id); break;
+        case GlResourceType::Texture: glGenTextures(1, &id); break;
+        case GlResourceType::Renderbuffer: glGenRenderbuffers(1, &id); break;
+        case GlResourceType::Framebuffer: glGenFramebuffers(1, &id); break;
+        case GlResourceType::VertexArray: glGenVertexArrays(1, &id); break;
+        case GlResourceType::Program: id = glCreateProgram(); break;
+        case GlResourceType::Query: glGenQueries(1, &id); break;
+        case GlResourceType::Count: break;
+    }
+    return id;
+}
+
+} // namespace gl_resources
+
+// Vlasnik jednog GL objekta; moze samo da se premesta. Implicitno se konvertuje u id,
+// pa se koristi direktno u gl* pozivima.
+template<GlResourceType Type>
+class GlHandle {
+public:
+    GlHandle() {}
+
+    ~GlHandle() {
+        Reset();
+    }
+
+    GlHandle(const GlHandle &) = delete;
+    GlHandle &operator=(const GlHandle &) = delete;
+
+    GlHandle(GlHandle &&other) noexcept : id(other.id) {
+        other.id = 0;
+    }
+
+    GlHandle &operator=(GlHandle &&other) noexcept {
+        if (this != &other) {
+            Reset();
+            id = other.id;
+            other.id = 0;
+        }
+        return *this;
+    }
+
+    static GlHandle Create(const std::string &label) {
+        return Adopt(gl_resources::Generate(Type), label);
+    }
+
+    // preuzimanje vlasnistva nad vec napravljenim objektom (npr. Shader::ID)
+    static GlHandle Adopt(unsigned int id, const std::string &label, size_t bytes = 0) {
+        GlHandle handle;
+        handle.id = id;
+        if (id != 0)
+            GlResourceRegistry::Get().Register(Type, id, label, bytes);
+        return handle;
+    }
+
+    void SetBytes(size_t bytes) {
+        GlResourceRegistry::Get().SetBytes(Type, id, bytes);
+    }
+
+    void Reset() {
+        if (id != 0) {
+            GlResourceRegistry::Get().Unregister(Type, id);
+            gl_resources::Delete(Type, id);
+            id = 0;
+        }
+    }
+
+    unsigned int Id() const {
+        return id;
+    }
+
+    operator unsigned int() const {
+        return id;
+    }
+
+private:
+    unsigned int id = 0;
+};
+
+typedef GlHandle<GlResourceType::Buffer> GlBuffer;
+typedef GlHandle<GlResourceType::Texture> GlTexture;
+typedef GlHandle<GlResourceType::Renderbuffer> GlRenderbuffer;
+typedef GlHandle<GlResourceType::Framebuffer> GlFramebuffer;
+typedef GlHandle<GlResourceType::VertexArray> GlVertexArray;
+typedef GlHandle<GlResourceType::Program> GlProgram;
+typedef GlHandle<GlResourceType::Query> GlQuery;
+
+// glBufferData + upis velicine u registar
+inline void GlBufferData(GlBuffer &buffer, GLenum target, size_t size, const void *data, GLenum usage) {
+    glBindBuffer(target, buffer);
+    glBufferData(target, (GLsizeiptr) size, data, usage);
+    buffer.SetBytes(size);
+}
+
+#endif
@@ -0,0 +1,608 @@
+#ifndef GPU_SCENE_H
+#define GPU_SCENE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <stb_image.h>
+
+#include <learnopengl/shader.h>
+
+#include <asset_manager.h>
+#include <culling.h>
+#include <frame_arena.h>
+#include <gl_resources.h>
+#include <lod.h>
+#include <texture_arrays.h>
+#include <uniforms.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Crtanje preko glMultiDrawElementsIndirect (GL 4.3+).
+//
+// Sva geometrija je u jednom vertex/index baferu sa zajednickim formatom temena. Podaci
+// o svakom crtanju (model matrica, boja, sfera za odsecanje, materijal) su u SSBO-u, a
+// shader ih cita preko drawId atributa (instanced atribut + baseInstance komande), pa
+// nije potreban gl_DrawID iz GL 4.6. Komande puni CPU ili compute shader koji usput
+// radi odsecanje po frustumu. Broj GL poziva po prolazu ne zavisi od broja objekata.
+// U sceni ovim putem idu modeli, podloge, stress instance, oblaci, svetlece kocke i bacaci
+// senki; pojedinacno ostaju samo skybox i prolazi preko celog ekrana.
+//
+// Teksture materijala su slojevi u nizovima tekstura (texture_arrays.h): crtanje nosi
+// indekse slojeva, pa su materijali cije su teksture u istim stranicama jedna grupa
+// i crtaju se istim MDI pozivom, bez menjanja vezanih tekstura. Ostali parametri
+// materijala (sjaj, skup svetala) su u SSBO-u materijala, po indeksu iz podataka crtanja.
+
+struct GpuVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+// raspored odgovara std430 strukturi DrawData u shaderima
+struct GpuDrawData {
+    glm::mat4 model;
+    glm::vec4 color;
+    glm::vec4 sphere;       // xyz centar, w radijus (u svetu)
+    glm::uvec4 material;    // x: indeks materijala, y/z: sloj diffuse/specular teksture, w: grupa stranica
+};
+
+// raspored odgovara std430 strukturi MaterialData u mdi_lit.vs
+struct GpuMaterialData {
+    float shininess;
+    unsigned int lightSet;      // skup svetala u mdi_lit.fs (modeli i podloge imaju razlicita svetla)
+    unsigned int padding[2];
+};
+
+// sloj koji ne postoji (tekstura nije ucitana)
+const unsigned int noTextureLayer = 0xFFFFFFFFu;
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+struct GeometryRange {
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    int baseVertex = 0;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+struct GpuMaterial {
+    TextureLayer diffuse;
+    TextureLayer specular;
+    unsigned int bindGroup = 0;
+    float shininess = 32.0f;
+    unsigned int lightSet = 0;
+};
+
+// par stranica nizova koje su vezane dok se crta grupa materijala
+struct MaterialBindGroup {
+    int diffusePage = -1;
+    int specularPage = -1;
+};
+
+inline bool MultiDrawSupported() {
+    return GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+}
+
+// compute shader se ucitava kao i ostali shaderi, ali Shader klasa podrzava samo vs/fs/gs
+inline GlProgram LoadComputeProgram(const char *path) {
+    std::ifstream file(path);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string code = stream.str();
+    const char *source = code.c_str();
+
+    unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    int success;
+    char infoLog[1024];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+        std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: COMPUTE\n" << infoLog << std::endl;
+    }
+
+    GlProgram program = GlProgram::Create(path);
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
+        std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: COMPUTE\n" << infoLog << std::endl;
+    }
+    glDeleteShader(shader);
+    return program;
+}
+
+class GpuScene {
+public:
+    GlVertexArray VAO;
+    std::vector<GpuMaterial> materials;
+    std::vector<MaterialBindGroup> bindGroups;
+    const TextureArrayManager *textureArrays = nullptr;
+
+    GeometryRange AddGeometry(const std::vector<GpuVertex> &newVertices, const unsigned int *newIndices, size_t indexCount) {
+        GeometryRange range;
+        range.firstIndex = (unsigned int) indices.size();
+        range.indexCount = (unsigned int) indexCount;
+        range.baseVertex = (int) vertices.size();
+
+        glm::vec3 minP(1e30f), maxP(-1e30f);
+        for (size_t i = 0; i < indexCount; i++) {
+            minP = glm::min(minP, newVertices[newIndices[i]].position);
+            maxP = glm::max(maxP, newVertices[newIndices[i]].position);
+        }
+        range.center = 0.5f * (minP + maxP);
+        range.radius = 0.5f * glm::length(maxP - minP);
+
+        vertices.insert(vertices.end(), newVertices.begin(), newVertices.end());
+        indices.insert(indices.end(), newIndices, newIndices + indexCount);
+        dirty = true;
+        return range;
+    }
+
+    // nekoliko opsega indeksa nad istim temenima (npr. LOD nivoi jedne mreze)
+    std::vector<GeometryRange> AddGeometryLevels(const std::vector<GpuVertex> &newVertices, const MeshLodData &lods) {
+        std::vector<GeometryRange> ranges;
+        int baseVertex = (int) vertices.size();
+        vertices.insert(vertices.end(), newVertices.begin(), newVertices.end());
+
+        glm::vec3 minP(1e30f), maxP(-1e30f);
+        for (const GpuVertex &v : newVertices) {
+            minP = glm::min(minP, v.position);
+            maxP = glm::max(maxP, v.position);
+        }
+        for (const LodLevel &level : lods.levels) {
+            GeometryRange range;
+            range.firstIndex = (unsigned int) indices.size();
+            range.indexCount = level.indexCount;
+            range.baseVertex = baseVertex;
+            range.center = 0.5f * (minP + maxP);
+            range.radius = 0.5f * glm::length(maxP - minP);
+            indices.insert(indices.end(), lods.indices.begin() + level.indexOffset,
+                           lods.indices.begin() + level.indexOffset + level.indexCount);
+            ranges.push_back(range);
+        }
+        dirty = true;
+        return ranges;
+    }
+
+    // materijali sa teksturama u istim stranicama dele grupu
+    unsigned int AddMaterial(const TextureLayer &diffuse, const TextureLayer &specular, float shininess = 32.0f,
+                             unsigned int lightSet = 0) {
+        GpuMaterial material;
+        material.diffuse = diffuse;
+        material.specular = specular;
+        material.shininess = shininess;
+        material.lightSet = lightSet;
+        material.bindGroup = (unsigned int) bindGroups.size();
+        for (unsigned int i = 0; i < bindGroups.size(); i++)
+            if (bindGroups[i].diffusePage == diffuse.page && bindGroups[i].specularPage == specular.page)
+                material.bindGroup = i;
+        if (material.bindGroup == bindGroups.size())
+            bindGroups.push_back({diffuse.page, specular.page});
+
+        materials.push_back(material);
+        materialsDirty = true;
+        return (unsigned int) materials.size() - 1;
+    }
+
+    // slanje spojenih bafera na GPU (samo kada je dodata nova geometrija ili materijal)
+    void Commit() {
+        if (materialsDirty) {
+            materialsDirty = false;
+            if (materialBuffer.Id() == 0)
+                materialBuffer = GlBuffer::Create("GpuScene materials");
+            std::vector<GpuMaterialData> data(materials.size());
+            for (size_t i = 0; i < materials.size(); i++)
+                data[i] = {materials[i].shininess, materials[i].lightSet, {0, 0}};
+            GlBufferData(materialBuffer, GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(GpuMaterialData), data.data(),
+                         GL_STATIC_DRAW);
+        }
+
+        if (!dirty)
+            return;
+        dirty = false;
+
+        if (VAO.Id() == 0) {
+            VAO = GlVertexArray::Create("GpuScene VAO");
+            VBO = GlBuffer::Create("GpuScene vertices");
+            EBO = GlBuffer::Create("GpuScene indices");
+            drawIds = GlBuffer::Create("GpuScene draw ids");
+        }
+
+        glBindVertexArray(VAO);
+        GlBufferData(VBO, GL_ARRAY_BUFFER, vertices.size() * sizeof(GpuVertex), vertices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GpuVertex), (void*)offsetof(GpuVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GpuVertex), (void*)offsetof(GpuVertex, normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GpuVertex), (void*)offsetof(GpuVertex, texCoords));
+        GlBufferData(EBO, GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        ReserveDrawIds(drawIdCapacity);
+        glBindVertexArray(0);
+    }
+
+    // drawId atribut: instanca 0 crtanja i cita drawIds[baseInstance] = i
+    void ReserveDrawIds(unsigned int count) {
+        if (count <= drawIdCapacity && drawIdsUploaded)
+            return;
+        drawIdCapacity = std::max(count, drawIdCapacity);
+        std::vector<unsigned int> ids(drawIdCapacity);
+        for (unsigned int i = 0; i < drawIdCapacity; i++)
+            ids[i] = i;
+
+        glBindVertexArray(VAO);
+        GlBufferData(drawIds, GL_ARRAY_BUFFER, ids.size() * sizeof(unsigned int), ids.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(3);
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+        glVertexAttribDivisor(3, 1);
+        glBindVertexArray(0);
+        drawIdsUploaded = true;
+    }
+
+    size_t VertexCount() const { return vertices.size(); }
+    size_t IndexCount() const { return indices.size(); }
+    unsigned int MaterialBuffer() const { return materialBuffer; }
+
+private:
+    GlBuffer VBO, EBO, drawIds, materialBuffer;
+    std::vector<GpuVertex> vertices;
+    std::vector<unsigned int> indices;
+    unsigned int drawIdCapacity = 1024;
+    bool drawIdsUploaded = false;
+    bool dirty = false;
+    bool materialsDirty = false;
+};
+
+// statistika jednog prolaza
+struct DrawBatchStats {
+    unsigned int draws = 0;
+    unsigned int submitted = 0;     // posle odsecanja na CPU
+    unsigned int gpuCulled = 0;     // compute shader, kasni frejm-dva (citanje bez cekanja)
+    unsigned int multiDrawCalls = 0;
+    unsigned int textureBinds = 0;
+};
+
+// Jedan prolaz: lista crtanja se puni svaki frejm i salje sa po jednim MDI pozivom po grupi stranica.
+class DrawBatch {
+public:
+    static const int culledReadbackSlots = 3;
+
+    DrawBatchStats stats;
+
+    explicit DrawBatch(const std::string &name) : name(name) {}
+
+    ~DrawBatch() {
+        for (CulledReadback &readback : culledReadbacks)
+            if (readback.fence)
+                glDeleteSync(readback.fence);
+    }
+
+    void Clear() {
+        draws.clear();
+        ranges.clear();
+    }
+
+    void Add(const GeometryRange &range, const glm::mat4 &model, const glm::vec4 &color, unsigned int material, float scale) {
+        GpuDrawData data;
+        data.model = model;
+        data.color = color;
+        data.sphere = glm::vec4(glm::vec3(model * glm::vec4(range.center, 1.0f)), range.radius * scale);
+        data.material = glm::uvec4(material, 0, 0, 0);
+        draws.push_back(data);
+        ranges.push_back(range);
+    }
+
+    // gpuCulling: komande se salju sve, a compute shader postavlja instanceCount = 0 za nevidljive;
+    // inace se odsecanje radi na CPU i salju se samo vidljive komande
+    void Submit(GpuScene &scene, Shader &shader, const Frustum &frustum, bool gpuCulling, const GlProgram &cullProgram,
+                bool bindMaterials) {
+        stats.draws = (unsigned int) draws.size();
+        stats.multiDrawCalls = 0;
+        stats.textureBinds = 0;
+        groups.clear();
+        if (draws.empty()) {
+            stats.submitted = 0;
+            return;
+        }
+
+        if (drawBuffer.Id() == 0) {
+            drawBuffer = GlBuffer::Create(name + " draw data");
+            commandBuffer = GlBuffer::Create(name + " indirect commands");
+            culledCounter = GlBuffer::Create(name + " culled counter");
+            unsigned int zero = 0;
+            GlBufferData(culledCounter, GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int), &zero, GL_DYNAMIC_DRAW);
+            for (int i = 0; i < culledReadbackSlots; i++) {
+                culledReadbacks[i].buffer = GlBuffer::Create(name + " culled readback " + std::to_string(i));
+                GlBufferData(culledReadbacks[i].buffer, GL_COPY_WRITE_BUFFER, sizeof(unsigned int), NULL, GL_STREAM_READ);
+            }
+        }
+
+        // slojevi i grupa iz materijala; redosled po grupi da bi svaka grupa bila jedan MDI poziv
+        FrameVector<unsigned int> order;
+        order.reserve(draws.size());
+        for (unsigned int i = 0; i < draws.size(); i++) {
+            glm::uvec4 &material = draws[i].material;
+            if (material.x < scene.materials.size()) {
+                const GpuMaterial &source = scene.materials[material.x];
+                material.y = source.diffuse.Valid() ? (unsigned int) source.diffuse.layer : noTextureLayer;
+                material.z = source.specular.Valid() ? (unsigned int) source.specular.layer : noTextureLayer;
+                material.w = source.bindGroup;
+            }
+            if (gpuCulling || frustum.TestSphere(glm::vec3(draws[i].sphere), draws[i].sphere.w))
+                order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+            return draws[a].material.w < draws[b].material.w;
+        });
+        stats.submitted = (unsigned int) order.size();
+        if (order.empty())
+            return;
+
+        FrameVector<GpuDrawData> sortedDraws;
+        FrameVector<DrawElementsIndirectCommand> commands;
+        sortedDraws.reserve(order.size());
+        commands.reserve(order.size());
+        for (unsigned int i = 0; i < order.size(); i++) {
+            const GeometryRange &range = ranges[order[i]];
+            sortedDraws.push_back(draws[order[i]]);
+            commands.push_back({range.indexCount, 1, range.firstIndex, range.baseVertex, i});
+        }
+        scene.ReserveDrawIds((unsigned int) sortedDraws.size());
+
+        UploadStream(drawBuffer, GL_SHADER_STORAGE_BUFFER, sortedDraws.size() * sizeof(GpuDrawData), sortedDraws.data(), drawCapacity);
+        UploadStream(commandBuffer, GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), commandCapacity);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawBuffer);
+
+        if (gpuCulling) {
+            // broj odsecenih iz ranijih frejmova (samo gotova citanja), pa reset brojaca
+            FetchCulled();
+            unsigned int culled = 0;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, culledCounter);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(unsigned int), &culled);
+
+            glUseProgram(cullProgram);
+            glUniform4fv(glGetUniformLocation(cullProgram, "planes"), 6, &frustum.planes[0][0]);
+            glUniform1ui(glGetUniformLocation(cullProgram, "drawCount"), (GLuint) commands.size());
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, culledCounter);
+            glDispatchCompute((GLuint) (commands.size() + 63) / 64, 1, 1);
+            glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+            QueueCulledReadback();
+        } else {
+            stats.gpuCulled = 0;
+        }
+
+        // grupe uzastopnih komandi sa istim stranicama tekstura
+        groups.clear();
+        for (unsigned int i = 0; i < commands.size(); i++) {
+            unsigned int bindGroup = sortedDraws[i].material.w;
+            if (groups.empty() || groups.back().bindGroup != bindGroup)
+                groups.push_back({bindGroup, i, 0});
+            groups.back().count++;
+        }
+
+        Draw(scene, shader, bindMaterials);
+    }
+
+    // ponovno crtanje poslednjih poslatih komandi (npr. posle depth pre-passa) bez novog slanja podataka
+    void Draw(GpuScene &scene, Shader &shader, bool bindMaterials) {
+        if (groups.empty())
+            return;
+
+        shader.use();
+        glBindVertexArray(scene.VAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawBuffer);
+        if (scene.MaterialBuffer() != 0)
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, scene.MaterialBuffer());
+
+        // stranica se vezuje samo kada se razlikuje od vec vezane
+        unsigned int bound[2] = {0, 0};
+        for (const CommandGroup &group : groups) {
+            if (bindMaterials && scene.textureArrays && group.bindGroup < scene.bindGroups.size()) {
+                const MaterialBindGroup &pages = scene.bindGroups[group.bindGroup];
+                unsigned int textures[2] = {scene.textureArrays->PageTexture(pages.diffusePage),
+                                            scene.textureArrays->PageTexture(pages.specularPage)};
+                for (int unit = 0; unit < 2; unit++) {
+                    if (textures[unit] == bound[unit] && bound[unit] != 0)
+                        continue;
+                    glActiveTexture(GL_TEXTURE0 + unit);
+                    glBindTexture(GL_TEXTURE_2D_ARRAY, textures[unit]);
+                    bound[unit] = textures[unit];
+                    stats.textureBinds++;
+                }
+                glActiveTexture(GL_TEXTURE0);
+            }
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                        (void*)(group.first * sizeof(DrawElementsIndirectCommand)),
+                                        group.count, 0);
+            stats.multiDrawCalls++;
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+private:
+    struct CommandGroup {
+        unsigned int bindGroup;
+        unsigned int first;
+        unsigned int count;
+    };
+
+    std::string name;
+    std::vector<GpuDrawData> draws;
+    std::vector<CommandGroup> groups;
+    std::vector<GeometryRange> ranges;
+    GlBuffer drawBuffer, commandBuffer, culledCounter;
+    size_t drawCapacity = 0;
+    size_t commandCapacity = 0;
+
+    // kopije brojaca sa fence-om; mapiraju se tek kada je GPU gotov (kao citanje Hi-Z nivoa)
+    struct CulledReadback {
+        GlBuffer buffer;
+        GLsync fence = nullptr;
+    };
+    CulledReadback culledReadbacks[culledReadbackSlots];
+    int oldestReadback = 0;
+    int pendingReadbacks = 0;
+
+    void QueueCulledReadback() {
+        // sva citanja su jos na GPU: ovaj frejm se preskace umesto cekanja
+        if (pendingReadbacks == culledReadbackSlots)
+            return;
+        CulledReadback &readback = culledReadbacks[(oldestReadback + pendingReadbacks) % culledReadbackSlots];
+        glBindBuffer(GL_COPY_READ_BUFFER, culledCounter);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(unsigned int));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pendingReadbacks++;
+    }
+
+    void FetchCulled() {
+        while (pendingReadbacks > 0) {
+            CulledReadback &readback = culledReadbacks[oldestReadback];
+            GLenum result = glClientWaitSync(readback.fence, 0, 0);
+            if (result == GL_TIMEOUT_EXPIRED)
+                return;
+            glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+            oldestReadback = (oldestReadback + 1) % culledReadbackSlots;
+            pendingReadbacks--;
+            if (result == GL_WAIT_FAILED)
+                continue;
+            glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer);
+            const void *data = glMapBufferRange(GL_COPY_READ_BUFFER, 0, sizeof(unsigned int), GL_MAP_READ_BIT);
+            if (data)
+                stats.gpuCulled = *(const unsigned int *) data;
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+    }
+
+    // bafer se realocira samo kada poraste, inace orphan + glBufferSubData
+    static void UploadStream(GlBuffer &buffer, GLenum target, size_t size, const void *data, size_t &capacity) {
+        glBindBuffer(target, buffer);
+        if (size > capacity) {
+            capacity = std::max(size, capacity * 2);
+            GlBufferData(buffer, target, capacity, NULL, GL_STREAM_DRAW);
+        } else {
+            glBufferData(target, (GLsizeiptr) capacity, NULL, GL_STREAM_DRAW);
+        }
+        glBufferSubData(target, 0, (GLsizeiptr) size, data);
+    }
+};
+
+// geometrija kocke iz main.cpp (pozicija, UV, normala) u zajednickom formatu
+inline GeometryRange AddInterleavedGeometry(GpuScene &scene, const float *data, unsigned int vertexCount) {
+    std::vector<GpuVertex> vertices(vertexCount);
+    std::vector<unsigned int> indices(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        const float *v = data + i * 8;
+        vertices[i].position = glm::vec3(v[0], v[1], v[2]);
+        vertices[i].texCoords = glm::vec2(v[3], v[4]);
+        vertices[i].normal = glm::vec3(v[5], v[6], v[7]);
+        indices[i] = i;
+    }
+    return scene.AddGeometry(vertices, indices.data(), indices.size());
+}
+
+// geometrija oblaka iz main.cpp (pozicija, UV) u zajednickom formatu, sa zadatom normalom
+inline GeometryRange AddTexturedGeometry(GpuScene &scene, const float *data, unsigned int vertexCount,
+                                         const glm::vec3 &normal) {
+    std::vector<GpuVertex> vertices(vertexCount);
+    std::vector<unsigned int> indices(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        const float *v = data + i * 5;
+        vertices[i].position = glm::vec3(v[0], v[1], v[2]);
+        vertices[i].texCoords = glm::vec2(v[3], v[4]);
+        vertices[i].normal = normal;
+        indices[i] = i;
+    }
+    return scene.AddGeometry(vertices, indices.data(), indices.size());
+}
+
+// slika sa diska kao jedan sloj niza tekstura (pri pokretanju, sinhrono); podloge i oblaci
+// se ovako dodaju u materijale MDI-ja, kao i teksture modela
+inline TextureLayer LoadTextureLayer(TextureArrayManager &arrays, const std::string &path, bool srgb) {
+    TextureLayer layer;
+    int width = 0, height = 0, components = 0;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &components, 0);
+    if (!data) {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        return layer;
+    }
+    int layerWidth = 0, layerHeight = 0;
+    arrays.LayerSize(width, height, layerWidth, layerHeight);
+    std::vector<unsigned char> pixels = ResampleRgba(data, width, height, components, layerWidth, layerHeight);
+    stbi_image_free(data);
+
+    layer = arrays.Allocate(layerWidth, layerHeight, srgb);
+    arrays.UploadRows(layer, 0, layerHeight, pixels.data());
+    arrays.GenerateMipmaps();
+    return layer;
+}
+
+// model iz AssetManager-a u spojenom baferu: opseg za svaki LOD nivo svake mreze + materijal mreze
+struct GpuModel {
+    std::vector<std::vector<GeometryRange>> meshLevels;
+    std::vector<unsigned int> meshMaterials;
+    bool registered = false;
+
+    void Register(GpuScene &scene, const ModelAsset &asset, float shininess, unsigned int lightSet) {
+        for (unsigned int m = 0; m < asset.meshes.size(); m++) {
+            const Mesh &mesh = asset.meshes[m];
+            std::vector<GpuVertex> vertices(mesh.vertices.size());
+            for (size_t i = 0; i < mesh.vertices.size(); i++) {
+                vertices[i].position = mesh.vertices[i].Position;
+                vertices[i].normal = mesh.vertices[i].Normal;
+                vertices[i].texCoords = mesh.vertices[i].TexCoords;
+            }
+            meshLevels.push_back(scene.AddGeometryLevels(vertices, asset.lodData[m]));
+
+            // sloj teksture mreze po indeksu uvezene teksture (GL imena se razlikuju kada se teksture strimuju)
+            TextureLayer diffuse, specular;
+            for (size_t k = 0; k < mesh.textures.size(); k++) {
+                const Texture &texture = mesh.textures[k];
+                unsigned int index = asset.meshTextures[m][k];
+                TextureLayer layer;
+                if (index < asset.textureLayers.size())
+                    layer = asset.textureLayers[index];
+                if (texture.type == "texture_diffuse" && !diffuse.Valid())
+                    diffuse = layer;
+                else if (texture.type == "texture_specular" && !specular.Valid())
+                    specular = layer;
+            }
+            meshMaterials.push_back(scene.AddMaterial(diffuse, specular, shininess, lightSet));
+        }
+        registered = true;
+    }
+
+    void Add(DrawBatch &batch, const glm::mat4 &model, float scale, int level) const {
+        for (unsigned int m = 0; m < meshLevels.size(); m++) {
+            const std::vector<GeometryRange> &levels = meshLevels[m];
+            const GeometryRange &range = levels[std::min(level, (int) levels.size() - 1)];
+            batch.Add(range, model, glm::vec4(1.0f), meshMaterials[m], scale);
+        }
+    }
+};
+
+#endif
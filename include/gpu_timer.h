@@ -0,0 +1,109 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include <gl_resources.h>
+
+#include <string>
+
+// Merenje vremena na GPU (GL_TIME_ELAPSED). Upiti se vrte u prstenu, pa se rezultat
+// cita tek kad je dostupan (par frejmova kasnije) i nikad se ne ceka na GPU.
+class GpuTimer {
+public:
+    static const int queryCount = 3;
+
+    explicit GpuTimer(const std::string &label) {
+        for (int i = 0; i < queryCount; i++)
+            queries[i] = GlQuery::Create(label + " timer " + std::to_string(i));
+    }
+
+    void Begin() {
+        glBeginQuery(GL_TIME_ELAPSED, queries[index]);
+    }
+
+    void End() {
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[index] = true;
+        index = (index + 1) % queryCount;
+
+        // najstariji upit je na redu za sledeci Begin
+        if (pending[index]) {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &nanoseconds);
+                milliseconds = nanoseconds / 1e6f;
+                pending[index] = false;
+                samples++;
+            }
+        }
+    }
+
+    // poslednji dostupan rezultat (0 dok prvi ne stigne)
+    float Milliseconds() const {
+        return milliseconds;
+    }
+
+    // broj procitanih rezultata; promena znaci da je Milliseconds() novo merenje
+    unsigned int Samples() const {
+        return samples;
+    }
+
+private:
+    GlQuery queries[queryCount];
+    bool pending[queryCount] = {};
+    int index = 0;
+    float milliseconds = 0.0f;
+    unsigned int samples = 0;
+};
+
+// Isto merenje parom GL_TIMESTAMP upita: moze unutar GpuTimer intervala
+// (GL_TIME_ELAPSED upiti se ne mogu ugnjezdavati).
+class GpuIntervalTimer {
+public:
+    static const int queryCount = 3;
+
+    explicit GpuIntervalTimer(const std::string &label) {
+        for (int i = 0; i < queryCount; i++) {
+            begin[i] = GlQuery::Create(label + " begin " + std::to_string(i));
+            end[i] = GlQuery::Create(label + " end " + std::to_string(i));
+        }
+    }
+
+    void Begin() {
+        glQueryCounter(begin[index], GL_TIMESTAMP);
+    }
+
+    void End() {
+        glQueryCounter(end[index], GL_TIMESTAMP);
+        pending[index] = true;
+        index = (index + 1) % queryCount;
+
+        if (pending[index]) {
+            GLint available = 0;
+            glGetQueryObjectiv(end[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 first = 0, last = 0;
+                glGetQueryObjectui64v(begin[index], GL_QUERY_RESULT, &first);
+                glGetQueryObjectui64v(end[index], GL_QUERY_RESULT, &last);
+                milliseconds = (last - first) / 1e6f;
+                pending[index] = false;
+            }
+        }
+    }
+
+    float Milliseconds() const {
+        return milliseconds;
+    }
+
+private:
+    GlQuery begin[queryCount];
+    GlQuery end[queryCount];
+    bool pending[queryCount] = {};
+    int index = 0;
+    float milliseconds = 0.0f;
+};
+
+#endif
@@ -0,0 +1,452 @@
+#ifndef IBL_H
+#define IBL_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <stb_image.h>
+
+#include <learnopengl/shader.h>
+
+#include <frame_arena.h>
+#include <gl_resources.h>
+#include <trace.h>
+#include <uniforms.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IBL_SSE 1
+#endif
+
+// Osvetljenje iz okoline (IBL) na osnovu skybox cubemape.
+//
+// Difuzni deo je iradijansa u 9 koeficijenata sfernih harmonika (SH9), projektovana na CPU
+// (SSE, 4 teksela odjednom, redovi strana podeljeni na niti). Spekularni deo je cubemapa
+// cije su mipmape filtrirane GGX raspodelom za rastucu hrapavost (na GPU). Rezultat se cuva
+// na disku pod hesom sadrzaja slika strana, pa se pri sledecem pokretanju samo ucitava;
+// ponovo se racuna tek kada se skybox promeni.
+//
+// Lit shaderi citaju: uniform vec3 shCoefficients[9], samplerCube prefilterMap i
+// float prefilterMaxLod (vidi mdi_lit.fs).
+
+namespace ibl {
+
+const uint32_t cacheVersion = 1;
+
+// FNV-1a nad bajtovima fajlova strana (i parametrima koji menjaju rezultat)
+inline uint64_t HashFaces(const std::vector<std::string> &faces, int prefilterSize, int prefilterLevels) {
+    uint64_t hash = 1469598103934665603ull;
+    auto add = [&hash](const unsigned char *data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            hash ^= data[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const std::string &path : faces) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        add(bytes.data(), bytes.size());
+    }
+    int parameters[3] = {(int) cacheVersion, prefilterSize, prefilterLevels};
+    add((const unsigned char *) parameters, sizeof(parameters));
+    return hash;
+}
+
+inline const float *SrgbToLinear() {
+    static float table[256];
+    static bool initialized = [] {
+        for (int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return true;
+    }();
+    (void) initialized;
+    return table;
+}
+
+// strana cubemape: pravac = ma + s * sc + t * tc (sc, tc u [-1, 1], redosled kao GL_TEXTURE_CUBE_MAP_POSITIVE_X + i)
+struct FaceBasis {
+    glm::vec3 ma, s, t;
+};
+
+inline const FaceBasis &Face(int face) {
+    static const FaceBasis faces[6] = {
+            {glm::vec3( 1, 0, 0), glm::vec3( 0, 0, -1), glm::vec3(0, -1,  0)},
+            {glm::vec3(-1, 0, 0), glm::vec3( 0, 0,  1), glm::vec3(0, -1,  0)},
+            {glm::vec3( 0, 1, 0), glm::vec3( 1, 0,  0), glm::vec3(0,  0,  1)},
+            {glm::vec3( 0,-1, 0), glm::vec3( 1, 0,  0), glm::vec3(0,  0, -1)},
+            {glm::vec3( 0, 0, 1), glm::vec3( 1, 0,  0), glm::vec3(0, -1,  0)},
+            {glm::vec3( 0, 0,-1), glm::vec3(-1, 0,  0), glm::vec3(0, -1,  0)}
+    };
+    return faces[face];
+}
+
+struct FaceImage {
+    unsigned char *data = nullptr;
+    int width = 0;
+    int height = 0;
+    int components = 0;
+};
+
+// zbir SH9 projekcije (27 = 9 koeficijenata x RGB) i zbir prostornih uglova
+struct ShSum {
+    float c[27] = {};
+    double weight = 0.0;
+};
+
+inline void AccumulateTexel(const glm::vec3 &dir, const float *color, float weight, ShSum &sum) {
+    float basis[9] = {
+            0.282095f,
+            0.488603f * dir.y, 0.488603f * dir.z, 0.488603f * dir.x,
+            1.092548f * dir.x * dir.y, 1.092548f * dir.y * dir.z, 0.315392f * (3.0f * dir.z * dir.z - 1.0f),
+            1.092548f * dir.x * dir.z, 0.546274f * (dir.x * dir.x - dir.y * dir.y)
+    };
+    for (int k = 0; k < 9; k++)
+        for (int c = 0; c < 3; c++)
+            sum.c[k * 3 + c] += basis[k] * color[c] * weight;
+    sum.weight += weight;
+}
+
+// redovi [rowBegin, rowEnd) jedne strane
+inline void ProjectRows(const FaceImage &image, int face, int rowBegin, int rowEnd, ShSum &sum) {
+    const float *linear = SrgbToLinear();
+    const FaceBasis &basis = Face(face);
+    const int w = image.width, h = image.height, n = image.components;
+    const float texelArea = 4.0f / ((float) w * h);
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        float tc = 2.0f * (y + 0.5f) / h - 1.0f;
+        const unsigned char *row = image.data + (size_t) y * w * n;
+        int x = 0;
+#ifdef IBL_SSE
+        __m128 acc[27];
+        for (int i = 0; i < 27; i++)
+            acc[i] = _mm_setzero_ps();
+        __m128 weightAcc = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 tcv = _mm_set1_ps(tc);
+        const __m128 area = _mm_set1_ps(texelArea);
+        for (; x + 4 <= w; x += 4) {
+            __m128 sc = _mm_set_ps(2.0f * (x + 3.5f) / w - 1.0f, 2.0f * (x + 2.5f) / w - 1.0f,
+                                   2.0f * (x + 1.5f) / w - 1.0f, 2.0f * (x + 0.5f) / w - 1.0f);
+            __m128 dx = _mm_add_ps(_mm_set1_ps(basis.ma.x), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(basis.s.x), sc), _mm_mul_ps(_mm_set1_ps(basis.t.x), tcv)));
+            __m128 dy = _mm_add_ps(_mm_set1_ps(basis.ma.y), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(basis.s.y), sc), _mm_mul_ps(_mm_set1_ps(basis.t.y), tcv)));
+            __m128 dz = _mm_add_ps(_mm_set1_ps(basis.ma.z), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(basis.s.z), sc), _mm_mul_ps(_mm_set1_ps(basis.t.z), tcv)));
+
+            // |d|^2 = 1 + sc^2 + tc^2; prostorni ugao teksela = povrsina / |d|^3
+            __m128 lengthSq = _mm_add_ps(one, _mm_add_ps(_mm_mul_ps(sc, sc), _mm_mul_ps(tcv, tcv)));
+            __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+            __m128 weight = _mm_mul_ps(area, _mm_mul_ps(invLength, _mm_mul_ps(invLength, invLength)));
+            dx = _mm_mul_ps(dx, invLength);
+            dy = _mm_mul_ps(dy, invLength);
+            dz = _mm_mul_ps(dz, invLength);
+
+            __m128 basisValues[9] = {
+                    _mm_set1_ps(0.282095f),
+                    _mm_mul_ps(_mm_set1_ps(0.488603f), dy),
+                    _mm_mul_ps(_mm_set1_ps(0.488603f), dz),
+                    _mm_mul_ps(_mm_set1_ps(0.488603f), dx),
+                    _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(dx, dy)),
+                    _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(dy, dz)),
+                    _mm_mul_ps(_mm_set1_ps(0.315392f), _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(dz, dz)), one)),
+                    _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(dx, dz)),
+                    _mm_mul_ps(_mm_set1_ps(0.546274f), _mm_sub_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)))
+            };
+
+            const unsigned char *p = row + (size_t) x * n;
+            __m128 color[3];
+            for (int c = 0; c < 3; c++) {
+                int channel = n >= 3 ? c : 0;
+                color[c] = _mm_mul_ps(weight, _mm_set_ps(linear[p[3 * n + channel]], linear[p[2 * n + channel]],
+                                                         linear[p[n + channel]], linear[p[channel]]));
+            }
+            for (int k = 0; k < 9; k++)
+                for (int c = 0; c < 3; c++)
+                    acc[k * 3 + c] = _mm_add_ps(acc[k * 3 + c], _mm_mul_ps(basisValues[k], color[c]));
+            weightAcc = _mm_add_ps(weightAcc, weight);
+        }
+        float lanes[4];
+        for (int i = 0; i < 27; i++) {
+            _mm_storeu_ps(lanes, acc[i]);
+            sum.c[i] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+        _mm_storeu_ps(lanes, weightAcc);
+        sum.weight += (double) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        // ostatak reda (ili ceo red bez SSE)
+        for (; x < w; x++) {
+            float sc = 2.0f * (x + 0.5f) / w - 1.0f;
+            glm::vec3 dir = basis.ma + basis.s * sc + basis.t * tc;
+            float lengthSq = glm::dot(dir, dir);
+            float weight = texelArea / (lengthSq * std::sqrt(lengthSq));
+            const unsigned char *p = row + (size_t) x * n;
+            float color[3];
+            for (int c = 0; c < 3; c++)
+                color[c] = linear[p[n >= 3 ? c : 0]];
+            AccumulateTexel(dir / std::sqrt(lengthSq), color, weight, sum);
+        }
+    }
+}
+
+// SH9 iradijanse podeljene sa pi (difuzna boja = albedo * suma c_k * Y_k(n))
+inline void ProjectIrradiance(const std::vector<FaceImage> &faces, glm::vec3 coefficients[9]) {
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<ShSum> sums(threadCount);
+    std::vector<std::thread> threads;
+
+    // svaka nit uzima svaki threadCount-ti blok od 16 redova svih strana
+    const int block = 16;
+    for (unsigned int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&faces, &sums, t, threadCount] {
+            int index = 0;
+            for (int face = 0; face < (int) faces.size(); face++) {
+                if (!faces[face].data)
+                    continue;
+                for (int row = 0; row < faces[face].height; row += block, index++)
+                    if (index % threadCount == t)
+                        ProjectRows(faces[face], face, row, std::min(row + block, faces[face].height), sums[t]);
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    ShSum total;
+    for (const ShSum &sum : sums) {
+        for (int i = 0; i < 27; i++)
+            total.c[i] += sum.c[i];
+        total.weight += sum.weight;
+    }
+
+    // normalizacija na 4*pi i konvolucija kosinusom (A_l / pi: 1, 2/3, 1/4)
+    const float band[9] = {1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f};
+    float normalization = total.weight > 0.0 ? (float) (4.0 * 3.14159265358979 / total.weight) : 0.0f;
+    for (int k = 0; k < 9; k++)
+        coefficients[k] = glm::vec3(total.c[k * 3], total.c[k * 3 + 1], total.c[k * 3 + 2]) * normalization * band[k];
+}
+
+} // namespace ibl
+
+class ImageBasedLighting {
+public:
+    static const int prefilterSize = 128;
+    static const int prefilterLevels = 5;
+
+    glm::vec3 shCoefficients[9];
+    GlTexture prefilterMap;
+
+    uint64_t hash = 0;
+    bool fromCache = false;
+    double loadMs = 0.0;
+    double shMs = 0.0;
+    double prefilterMs = 0.0;
+
+    // skybox cubemapa (faces su iste slike kao u loadCubemap); cubeVAO je jedinicna kocka (36 temena)
+    void Load(const std::vector<std::string> &faces, GlTexture &environment, unsigned int cubeVAO,
+              const std::string &cacheDirectory = "resources/") {
+        TraceZone zone("Image-based lighting", "asset");
+        auto start = std::chrono::steady_clock::now();
+        hash = ibl::HashFaces(faces, prefilterSize, prefilterLevels);
+        char name[64];
+        std::snprintf(name, sizeof(name), "ibl_cache_%016llx.bin", (unsigned long long) hash);
+        std::string cachePath = cacheDirectory + name;
+
+        fromCache = ReadCache(cachePath);
+        if (!fromCache) {
+            Bake(faces, environment, cubeVAO);
+            WriteCache(cachePath);
+        }
+        loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // SH koeficijenti i prefiltrirana mapa na zadatoj jedinici teksture
+    void Apply(Shader &shader, int unit, float intensity) const {
+        shader.use();
+        FrameArena &arena = ThreadFrameArena();
+        for (int k = 0; k < 9; k++)
+            SetVec3(shader, arena.Format("shCoefficients[%d]", k), shCoefficients[k] * intensity);
+        SetInt(shader, "prefilterMap", unit);
+        SetFloat(shader, "prefilterMaxLod", (float) (prefilterLevels - 1));
+        SetFloat(shader, "prefilterIntensity", intensity);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    void AllocatePrefilterMap() {
+        prefilterMap = GlTexture::Create("IBL prefiltered specular");
+        prefilterMap.SetBytes(EstimateTextureBytes(GL_RGB16F, prefilterSize, prefilterSize, 6, true));
+        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+        for (int level = 0; level < prefilterLevels; level++)
+            for (int face = 0; face < 6; face++)
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, GL_RGB16F, prefilterSize >> level,
+                             prefilterSize >> level, 0, GL_RGB, GL_HALF_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, prefilterLevels - 1);
+    }
+
+    // kes: zaglavlje, SH koeficijenti, pa svi nivoi svih strana (RGB16F)
+    bool ReadCache(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        uint32_t version = 0;
+        uint64_t storedHash = 0;
+        file.read((char *) &version, sizeof(version));
+        file.read((char *) &storedHash, sizeof(storedHash));
+        if (!file || version != ibl::cacheVersion || storedHash != hash)
+            return false;
+        file.read((char *) shCoefficients, sizeof(shCoefficients));
+
+        std::vector<std::vector<uint16_t>> levels(prefilterLevels * 6);
+        for (int level = 0; level < prefilterLevels; level++)
+            for (int face = 0; face < 6; face++) {
+                int size = prefilterSize >> level;
+                std::vector<uint16_t> &pixels = levels[level * 6 + face];
+                pixels.resize((size_t) size * size * 3);
+                file.read((char *) pixels.data(), pixels.size() * sizeof(uint16_t));
+            }
+        if (!file)
+            return false;
+
+        AllocatePrefilterMap();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int level = 0; level < prefilterLevels; level++)
+            for (int face = 0; face < 6; face++) {
+                int size = prefilterSize >> level;
+                glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, 0, 0, size, size, GL_RGB, GL_HALF_FLOAT,
+                                levels[level * 6 + face].data());
+            }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return true;
+    }
+
+    void WriteCache(const std::string &path) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cout << "IBL cache could not be written: " << path << std::endl;
+            return;
+        }
+        file.write((const char *) &ibl::cacheVersion, sizeof(ibl::cacheVersion));
+        file.write((const char *) &hash, sizeof(hash));
+        file.write((const char *) shCoefficients, sizeof(shCoefficients));
+
+        std::vector<uint16_t> pixels;
+        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        for (int level = 0; level < prefilterLevels; level++)
+            for (int face = 0; face < 6; face++) {
+                int size = prefilterSize >> level;
+                pixels.resize((size_t) size * size * 3);
+                glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, GL_RGB, GL_HALF_FLOAT, pixels.data());
+                file.write((const char *) pixels.data(), pixels.size() * sizeof(uint16_t));
+            }
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    }
+
+    void Bake(const std::vector<std::string> &faces, GlTexture &environment, unsigned int cubeVAO) {
+        // dekodiranje strana paralelno, pa SH projekcija na svim jezgrima
+        auto start = std::chrono::steady_clock::now();
+        std::vector<ibl::FaceImage> images(faces.size());
+        {
+            std::vector<std::thread> decoders;
+            for (size_t i = 0; i < faces.size(); i++)
+                decoders.emplace_back([&images, &faces, i] {
+                    ibl::FaceImage &image = images[i];
+                    image.data = stbi_load(faces[i].c_str(), &image.width, &image.height, &image.components, 0);
+                });
+            for (std::thread &decoder : decoders)
+                decoder.join();
+        }
+        ibl::ProjectIrradiance(images, shCoefficients);
+        for (ibl::FaceImage &image : images)
+            stbi_image_free(image.data);
+        shMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        Prefilter(environment, cubeVAO);
+        prefilterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // GGX filtriranje po nivoima hrapavosti (nivo / (broj nivoa - 1)); izvor dobija mipmape za
+    // uzorkovanje po gustini uzoraka, a skybox ga i dalje crta sa osnovnog nivoa
+    void Prefilter(GlTexture &environment, unsigned int cubeVAO) {
+        Shader prefilterShader("resources/shaders/ibl_prefilter.vs", "resources/shaders/ibl_prefilter.fs");
+        GlProgram prefilterProgram = GlProgram::Adopt(prefilterShader.ID, "IBL prefilter");
+
+        GLint environmentSize = 0;
+        glBindTexture(GL_TEXTURE_CUBE_MAP, environment);
+        glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &environmentSize);
+        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        environment.SetBytes(EstimateTextureBytes(GL_SRGB, environmentSize, environmentSize, 6, true));
+
+        AllocatePrefilterMap();
+        GlFramebuffer captureFBO = GlFramebuffer::Create("IBL prefilter FBO");
+
+        glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
+        glm::mat4 captureViews[6] = {
+                glm::lookAt(glm::vec3(0.0f), glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
+                glm::lookAt(glm::vec3(0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
+                glm::lookAt(glm::vec3(0.0f), glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
+                glm::lookAt(glm::vec3(0.0f), glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
+                glm::lookAt(glm::vec3(0.0f), glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
+                glm::lookAt(glm::vec3(0.0f), glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
+        };
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+
+        prefilterShader.use();
+        SetInt(prefilterShader, "environmentMap", 0);
+        SetFloat(prefilterShader, "environmentSize", (float) environmentSize);
+        SetMat4(prefilterShader, "projection", captureProjection);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, environment);
+        glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+        glBindVertexArray(cubeVAO);
+        for (int level = 0; level < prefilterLevels; level++) {
+            int size = prefilterSize >> level;
+            glViewport(0, 0, size, size);
+            SetFloat(prefilterShader, "roughness", (float) level / (float) (prefilterLevels - 1));
+            for (int face = 0; face < 6; face++) {
+                SetMat4(prefilterShader, "view", captureViews[face]);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+                                       prefilterMap, level);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+        glBindVertexArray(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        if (depthTest)
+            glEnable(GL_DEPTH_TEST);
+        if (cullFace)
+            glEnable(GL_CULL_FACE);
+    }
+};
+
+#endif
@@ -0,0 +1,548 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/model.h>
+
+#include <frame_arena.h>
+#include <gl_resources.h>
+#include <uniforms.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// LOD nivoi za Assimp modele: pojednostavljivanje mreze pomocu quadric error metrics
+// (Garland & Heckbert) i izbor nivoa na osnovu greske u pikselima na ekranu.
+//
+// Svi nivoi jedne mreze dele isti vertex buffer; razlikuju se samo u indeksima.
+// Indeksi svih nivoa su spakovani u jedan EBO (nivo 0 je originalni index buffer),
+// pa Mesh::Draw i dalje crta pun model.
+
+struct LodLevel {
+    unsigned int indexOffset;
+    unsigned int indexCount;
+    float error;                // greska u prostoru objekta (u jedinicama modela)
+};
+
+// CPU podaci: mogu da se racunaju van render niti
+struct MeshLodData {
+    std::vector<unsigned int> indices;
+    std::vector<LodLevel> levels;
+};
+
+// GPU podaci jedne mreze
+struct MeshLods {
+    GlBuffer EBO;
+    std::vector<LodLevel> levels;
+};
+
+namespace lod {
+
+// simetricna 4x4 kvadrika, cuva se gornji trougao + ukupna tezina
+struct Quadric {
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, w;
+};
+
+inline void QuadricZero(Quadric &q) {
+    std::memset(&q, 0, sizeof(Quadric));
+}
+
+inline void QuadricAdd(Quadric &q, const Quadric &o) {
+    q.a2 += o.a2; q.ab += o.ab; q.ac += o.ac; q.ad += o.ad;
+    q.b2 += o.b2; q.bc += o.bc; q.bd += o.bd;
+    q.c2 += o.c2; q.cd += o.cd;
+    q.d2 += o.d2;
+    q.w += o.w;
+}
+
+inline void QuadricAddPlane(Quadric &q, double a, double b, double c, double d, double w) {
+    q.a2 += w * a * a; q.ab += w * a * b; q.ac += w * a * c; q.ad += w * a * d;
+    q.b2 += w * b * b; q.bc += w * b * c; q.bd += w * b * d;
+    q.c2 += w * c * c; q.cd += w * c * d;
+    q.d2 += w * d * d;
+    q.w += w;
+}
+
+// kvadrat rastojanja tacke od ravni kvadrike (normalizovano tezinom)
+inline double QuadricError(const Quadric &q, const glm::vec3 &p) {
+    double x = p.x, y = p.y, z = p.z;
+    double e = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z
+               + 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z)
+               + 2.0 * (q.ad * x + q.bd * y + q.cd * z)
+               + q.d2;
+    e = e < 0.0 ? 0.0 : e;
+    return q.w > 0.0 ? e / q.w : e;
+}
+
+struct Collapse {
+    double cost;
+    unsigned int from;          // grupa koja nestaje
+    unsigned int to;            // grupa na ciju poziciju se pomera
+    unsigned int target;        // teme grupe 'to' sa ivice, preuzima sva temena grupe 'from'
+
+    bool operator<(const Collapse &o) const { return cost < o.cost; }
+};
+
+// ivica izmedju dve grupe + jedan par temena koji je cini
+struct Edge {
+    unsigned long long key;
+    unsigned int a, b;
+
+    bool operator<(const Edge &o) const { return key < o.key; }
+};
+
+inline unsigned long long EdgeKey(unsigned int a, unsigned int b) {
+    if (a > b)
+        std::swap(a, b);
+    return ((unsigned long long) a << 32) | b;
+}
+
+struct PositionHash {
+    size_t operator()(const glm::vec3 &p) const {
+        unsigned int h[3];
+        std::memcpy(h, &p.x, sizeof(h));
+        return (h[0] * 73856093u) ^ (h[1] * 19349663u) ^ (h[2] * 83492791u);
+    }
+};
+
+struct PositionEqual {
+    bool operator()(const glm::vec3 &a, const glm::vec3 &b) const {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+};
+
+// temena na istoj poziciji sa istim UV i normalom su ista tacka povrsine
+inline bool SameAttributes(const Vertex &a, const Vertex &b) {
+    return glm::length(a.TexCoords - b.TexCoords) < 1e-5f && glm::length(a.Normal - b.Normal) < 1e-3f;
+}
+
+// provera da li bi pomeranje grupe 'from' na poziciju grupe 'to' okrenulo neki od susednih
+// trouglova; groups su indeksi trouglova prevedeni u grupe
+inline bool CollapseFlips(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &groups,
+                          const std::vector<unsigned int> &adjacencyOffsets, const std::vector<unsigned int> &adjacency,
+                          unsigned int from, unsigned int to) {
+    const glm::vec3 &target = positions[to];
+    for (unsigned int k = adjacencyOffsets[from]; k < adjacencyOffsets[from + 1]; k++) {
+        unsigned int t = adjacency[k];
+        unsigned int i0 = groups[t * 3 + 0], i1 = groups[t * 3 + 1], i2 = groups[t * 3 + 2];
+        // trouglovi koji sadrze ivicu from-to nestaju
+        if (i0 == to || i1 == to || i2 == to)
+            continue;
+
+        glm::vec3 p0 = positions[i0], p1 = positions[i1], p2 = positions[i2];
+        glm::vec3 before = glm::cross(p1 - p0, p2 - p0);
+        if (i0 == from) p0 = target;
+        if (i1 == from) p1 = target;
+        if (i2 == from) p2 = target;
+        glm::vec3 after = glm::cross(p1 - p0, p2 - p0);
+
+        if (glm::dot(before, after) <= 1e-3f * glm::dot(before, before))
+            return true;
+    }
+    return false;
+}
+
+} // namespace lod
+
+// Pojednostavljuje listu trouglova do targetIndexCount indeksa (ili dok greska ne predje maxError).
+// Temena ostaju ista, menjaju se samo indeksi, pa vertex atributi (normale, UV) ostaju validni.
+//
+// Topologija se gradi nad grupama temena na istoj poziciji (Assimp bez JoinIdenticalVertices
+// daje svakom uglu trougla posebno teme), i cela grupa se pomera zajedno. Ne pomeraju se samo
+// grupe na granici mreze i grupe ciji se atributi razlikuju (UV ili normal savovi); na njih
+// druge grupe i dalje mogu da se spoje.
+inline std::vector<unsigned int> SimplifyMesh(const std::vector<Vertex> &vertices,
+                                              const std::vector<unsigned int> &sourceIndices,
+                                              size_t targetIndexCount, float maxError, float *resultError) {
+    using namespace lod;
+
+    const unsigned int vertexCount = (unsigned int) vertices.size();
+    std::vector<glm::vec3> positions(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; i++)
+        positions[i] = vertices[i].Position;
+    std::vector<unsigned int> indices(sourceIndices);
+    double worstCost = 0.0;
+
+    // grupe: id grupe je prvo teme na toj poziciji; grupa sa razlicitim atributima je sav
+    std::vector<unsigned int> welded(vertexCount);
+    std::vector<unsigned char> locked(vertexCount, 0);
+    {
+        std::unordered_map<glm::vec3, unsigned int, PositionHash, PositionEqual> firstAt;
+        firstAt.reserve(vertexCount);
+        for (unsigned int i = 0; i < vertexCount; i++) {
+            auto it = firstAt.find(positions[i]);
+            if (it == firstAt.end()) {
+                firstAt.emplace(positions[i], i);
+                welded[i] = i;
+            } else {
+                welded[i] = it->second;
+                if (!SameAttributes(vertices[i], vertices[it->second]))
+                    locked[it->second] = 1;
+            }
+        }
+    }
+
+    // clanovi svake grupe (grupa se pomera cela)
+    std::vector<unsigned int> memberOffsets(vertexCount + 1, 0);
+    std::vector<unsigned int> members(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; i++)
+        memberOffsets[welded[i] + 1]++;
+    for (unsigned int i = 0; i < vertexCount; i++)
+        memberOffsets[i + 1] += memberOffsets[i];
+    {
+        std::vector<unsigned int> fill(memberOffsets.begin(), memberOffsets.end() - 1);
+        for (unsigned int i = 0; i < vertexCount; i++)
+            members[fill[welded[i]]++] = i;
+    }
+
+    // granice: ivica izmedju grupa koju koristi samo jedan trougao
+    {
+        std::unordered_map<unsigned long long, unsigned int> edgeUse;
+        edgeUse.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+            for (int e = 0; e < 3; e++)
+                edgeUse[EdgeKey(welded[indices[i + e]], welded[indices[i + (e + 1) % 3]])]++;
+        for (size_t i = 0; i < indices.size(); i += 3)
+            for (int e = 0; e < 3; e++) {
+                unsigned int a = welded[indices[i + e]], b = welded[indices[i + (e + 1) % 3]];
+                if (edgeUse[EdgeKey(a, b)] == 1) {
+                    locked[a] = 1;
+                    locked[b] = 1;
+                }
+            }
+    }
+
+    // kvadrike grupa iz ravni susednih trouglova (tezina = povrsina)
+    std::vector<Quadric> quadrics(vertexCount);
+    for (Quadric &q : quadrics)
+        QuadricZero(q);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const glm::vec3 &p0 = positions[indices[i]], &p1 = positions[indices[i + 1]], &p2 = positions[indices[i + 2]];
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        float len = glm::length(n);
+        if (len <= 0.0f)
+            continue;
+        n = n / len;
+        double d = -glm::dot(n, p0);
+        for (int k = 0; k < 3; k++)
+            QuadricAddPlane(quadrics[welded[indices[i + k]]], n.x, n.y, n.z, d, 0.5 * len);
+    }
+
+    const double maxCost = (double) maxError * (double) maxError;
+    std::vector<unsigned int> groups;
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<unsigned char> touched(vertexCount);
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<Edge> edges;
+    std::vector<Collapse> collapses;
+
+    while (indices.size() > targetIndexCount) {
+        const size_t triangleCount = indices.size() / 3;
+
+        groups.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+            groups[i] = welded[indices[i]];
+
+        // grupa -> trouglovi
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (unsigned int g : groups)
+            adjacencyOffsets[g + 1]++;
+        for (unsigned int i = 0; i < vertexCount; i++)
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        adjacency.resize(groups.size());
+        {
+            std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < groups.size(); i++)
+                adjacency[fill[groups[i]]++] = (unsigned int) (i / 3);
+        }
+
+        // jedinstvene ivice izmedju grupa i cena kolapsa
+        edges.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+            for (int e = 0; e < 3; e++) {
+                unsigned int a = indices[i + e], b = indices[i + (e + 1) % 3];
+                edges.push_back({EdgeKey(welded[a], welded[b]), a, b});
+            }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end(),
+                                [](const Edge &x, const Edge &y) { return x.key == y.key; }),
+                    edges.end());
+
+        collapses.clear();
+        for (const Edge &edge : edges) {
+            unsigned int a = welded[edge.a], b = welded[edge.b];
+            if (a == b)
+                continue;
+
+            Quadric q = quadrics[a];
+            QuadricAdd(q, quadrics[b]);
+
+            Collapse best = {1e300, a, b, edge.b};
+            if (!locked[a])
+                best.cost = QuadricError(q, positions[b]);
+            if (!locked[b]) {
+                double cost = QuadricError(q, positions[a]);
+                if (cost < best.cost)
+                    best = {cost, b, a, edge.a};
+            }
+            if (best.cost <= maxCost)
+                collapses.push_back(best);
+        }
+        if (collapses.empty())
+            break;
+        std::sort(collapses.begin(), collapses.end());
+
+        // svaki kolaps uklanja ~2 trougla
+        size_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+        size_t collapseLimit = trianglesToRemove / 2 + 1;
+
+        for (unsigned int i = 0; i < vertexCount; i++)
+            remap[i] = i;
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t collapsed = 0;
+        for (const Collapse &c : collapses) {
+            if (collapsed >= collapseLimit)
+                break;
+            if (touched[c.from] || touched[c.to])
+                continue;
+            if (CollapseFlips(positions, groups, adjacencyOffsets, adjacency, c.from, c.to))
+                continue;
+
+            // grupa 'from' nije sav, pa sva njena temena imaju iste atribute kao teme sa ivice
+            for (unsigned int k = memberOffsets[c.from]; k < memberOffsets[c.from + 1]; k++)
+                remap[members[k]] = c.target;
+            QuadricAdd(quadrics[c.to], quadrics[c.from]);
+            worstCost = std::max(worstCost, c.cost);
+            collapsed++;
+
+            // zakljucavanje okoline da bi provera okretanja ostala tacna u ovom prolazu
+            for (unsigned int k = adjacencyOffsets[c.from]; k < adjacencyOffsets[c.from + 1]; k++) {
+                unsigned int t = adjacency[k];
+                touched[groups[t * 3 + 0]] = 1;
+                touched[groups[t * 3 + 1]] = 1;
+                touched[groups[t * 3 + 2]] = 1;
+            }
+        }
+        if (collapsed == 0)
+            break;
+
+        // primena kolapsa i izbacivanje degenerisanih trouglova (dva ugla u istoj grupi)
+        size_t write = 0;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            unsigned int a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+            if (welded[a] == welded[b] || welded[b] == welded[c] || welded[a] == welded[c])
+                continue;
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+        indices.resize(write);
+    }
+
+    if (resultError)
+        *resultError = (float) std::sqrt(worstCost);
+    return indices;
+}
+
+// Pravi do levelCount nivoa; svaki sledeci ima otprilike pola trouglova prethodnog.
+// Pravljenje se zaustavlja kada pojednostavljivanje vise ne napreduje.
+inline MeshLodData BuildMeshLods(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                                 int levelCount = 4) {
+    MeshLodData data;
+    data.indices = indices;
+    data.levels.push_back({0, (unsigned int) indices.size(), 0.0f});
+
+    glm::vec3 minP(1e30f), maxP(-1e30f);
+    for (const Vertex &v : vertices) {
+        minP = glm::min(minP, v.Position);
+        maxP = glm::max(maxP, v.Position);
+    }
+    // greska nivoa je ogranicena na 10% velicine mreze, krupnije od toga nema smisla
+    float maxError = vertices.empty() ? 0.0f : 0.1f * glm::length(maxP - minP);
+
+    std::vector<unsigned int> previous = indices;
+    float previousError = 0.0f;
+    for (int level = 1; level < levelCount; level++) {
+        size_t target = (previous.size() / 2) / 3 * 3;
+        if (target < 3 * 8)
+            break;
+
+        float error = 0.0f;
+        std::vector<unsigned int> simplified = SimplifyMesh(vertices, previous, target, maxError, &error);
+        if (simplified.empty() || simplified.size() > previous.size() * 9 / 10)
+            break;
+
+        error = std::max(error, previousError);
+        data.levels.push_back({(unsigned int) data.indices.size(), (unsigned int) simplified.size(), error});
+        data.indices.insert(data.indices.end(), simplified.begin(), simplified.end());
+
+        previous.swap(simplified);
+        previousError = error;
+    }
+    return data;
+}
+
+// Postavlja spojeni index buffer svih nivoa u VAO mreze. Nivo 0 je na pocetku bafera,
+// tako da i obican Mesh::Draw radi kao pre. Originalni EBO mreze se brise (Mesh ga ne brise
+// sam, a posle zamene ga vise nista ne koristi).
+inline MeshLods UploadMeshLods(const Mesh &mesh, const MeshLodData &data) {
+    MeshLods lods;
+    lods.levels = data.levels;
+
+    lods.EBO = GlBuffer::Create("LOD indices");
+    glBindVertexArray(mesh.VAO);
+    GLint original = 0;
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &original);
+    GlBufferData(lods.EBO, GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(unsigned int), data.indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+
+    if (original != 0) {
+        GLuint id = (GLuint) original;
+        glDeleteBuffers(1, &id);
+    }
+    return lods;
+}
+
+// isto vezivanje tekstura kao u Mesh::Draw, ali sa izabranim nivoom; imena uniform
+// promenljivih se prave u areni frejma umesto na hipu
+inline void DrawMeshLod(const Mesh &mesh, const MeshLods &lods, Shader &shader, int level) {
+    FrameArena &arena = ThreadFrameArena();
+    unsigned int diffuseNr = 1;
+    unsigned int specularNr = 1;
+    unsigned int normalNr = 1;
+    unsigned int heightNr = 1;
+    for (unsigned int i = 0; i < mesh.textures.size(); i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        unsigned int number = 0;
+        const std::string &name = mesh.textures[i].type;
+        if (name == "texture_diffuse")
+            number = diffuseNr++;
+        else if (name == "texture_specular")
+            number = specularNr++;
+        else if (name == "texture_normal")
+            number = normalNr++;
+        else if (name == "texture_height")
+            number = heightNr++;
+
+        const char *uniform = arena.Format("%s%s%u", mesh.glslIdentifierPrefix.c_str(), name.c_str(), number);
+        SetInt(shader, uniform, i);
+        glBindTexture(GL_TEXTURE_2D, mesh.textures[i].id);
+    }
+
+    const LodLevel &l = lods.levels[std::min(level, (int) lods.levels.size() - 1)];
+    glBindVertexArray(mesh.VAO);
+    glDrawElements(GL_TRIANGLES, l.indexCount, GL_UNSIGNED_INT, (void *) (l.indexOffset * sizeof(unsigned int)));
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+// Model sa LOD nivoima za svaku mrezu. Nivo se bira za ceo model, greska nivoa je
+// najveca greska medju mrezama. Mreze mogu da se dodaju i postepeno (asinhrono ucitavanje),
+// crtaju se samo one koje vec imaju LOD podatke.
+class LodModel {
+public:
+    std::vector<Mesh> *meshes = nullptr;
+    std::vector<MeshLods> meshLods;
+    std::vector<float> levelErrors;
+    std::vector<unsigned int> levelTriangles;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    LodModel() {}
+
+    explicit LodModel(Model &model, int levelCount = 4) : meshes(&model.meshes) {
+        glm::vec3 minP(1e30f), maxP(-1e30f);
+        for (const Mesh &mesh : model.meshes)
+            for (const Vertex &v : mesh.vertices) {
+                minP = glm::min(minP, v.Position);
+                maxP = glm::max(maxP, v.Position);
+            }
+        SetBounds(minP, maxP);
+
+        for (const Mesh &mesh : model.meshes)
+            AddMesh(UploadMeshLods(mesh, BuildMeshLods(mesh.vertices, mesh.indices, levelCount)));
+    }
+
+    void SetBounds(const glm::vec3 &minP, const glm::vec3 &maxP) {
+        center = 0.5f * (minP + maxP);
+        radius = 0.5f * glm::length(maxP - minP);
+    }
+
+    // broj nivoa modela je najveci broj nivoa medju mrezama; mreza sa manje nivoa na grubljim
+    // nivoima modela crta svoj poslednji (isto ogranicenje kao u DrawMeshLod)
+    void AddMesh(MeshLods &&lods) {
+        meshLods.push_back(std::move(lods));
+
+        int levels = 0;
+        for (const MeshLods &m : meshLods)
+            levels = std::max(levels, (int) m.levels.size());
+
+        levelErrors.assign(levels, 0.0f);
+        levelTriangles.assign(levels, 0);
+        for (const MeshLods &m : meshLods) {
+            for (int l = 0; l < levels; l++) {
+                const LodLevel &level = m.levels[std::min(l, (int) m.levels.size() - 1)];
+                levelErrors[l] = std::max(levelErrors[l], level.error);
+                levelTriangles[l] += level.indexCount / 3;
+            }
+        }
+    }
+
+    int LevelCount() const {
+        return (int) levelErrors.size();
+    }
+
+    void Draw(Shader &shader, int level) {
+        for (unsigned int i = 0; i < meshLods.size(); i++)
+            DrawMeshLod((*meshes)[i], meshLods[i], shader, level);
+    }
+
+    void Release() {
+        meshLods.clear();
+        levelErrors.clear();
+        levelTriangles.clear();
+    }
+};
+
+// Izbor nivoa po gresci na ekranu u pikselima, sa histerezom: na grublji nivo se prelazi tek
+// kada je greska dovoljno ispod praga, na finiji cim se prag predje.
+struct LodSelector {
+    float pixelError = 1.0f;
+    float hysteresis = 0.25f;
+    float projectionScale = 1.0f;   // visina viewporta / (2 * tan(fovy / 2))
+
+    void SetProjection(float fovyRadians, float viewportHeight) {
+        projectionScale = viewportHeight / (2.0f * std::tan(fovyRadians * 0.5f));
+    }
+
+    float ScreenError(float objectError, float scale, float distance) const {
+        return objectError * scale * projectionScale / std::max(distance, 1e-3f);
+    }
+
+    int Select(const LodModel &lodModel, int current, const glm::mat4 &modelMatrix, float scale,
+               const glm::vec3 &cameraPosition) const {
+        glm::vec3 worldCenter = glm::vec3(modelMatrix * glm::vec4(lodModel.center, 1.0f));
+        float distance = glm::length(cameraPosition - worldCenter) - lodModel.radius * scale;
+
+        int level = 0;
+        for (int l = lodModel.LevelCount() - 1; l > 0; l--) {
+            float threshold = l > current ? pixelError * (1.0f - hysteresis) : pixelError;
+            if (ScreenError(lodModel.levelErrors[l], scale, distance) <= threshold) {
+                level = l;
+                break;
+            }
+        }
+        return level;
+    }
+};
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+
+#include <gl_resources.h>
+#include <uniforms.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hijerarhijski Z bafer (Hi-Z) za odsecanje zaklonjenih objekata.
+//
+// Posle neprozirnog dela scene od kopije dubine (scene_depth.h) se pravi
+// piramida maksimalnih dubina (svaki nivo je max 2x2 prethodnog). Jedan grub nivo se
+// asinhrono cita na CPU (PBO), pa sledeci frejm proverava sfere objekata pre slanja na
+// crtanje: objekat je zaklonjen ako mu je najbliza dubina iza najdalje dubine u svim
+// tekselima koje pokriva. Projekcija se radi sa matricom frejma iz kog je dubina, pa je
+// test tacan za staticne zaklanjace; pokretni objekti mogu da kasne jedan frejm.
+
+class HiZBuffer {
+public:
+    // nivo piramide koji se cita na CPU je prvi cija sirina nije veca od ovoga
+    static const int readbackMaxWidth = 128;
+
+    HiZBuffer(int width, int height)
+            : width(width), height(height) {
+        // piramida pocinje od pola rezolucije
+        int w = std::max(1, width / 2), h = std::max(1, height / 2);
+        levelCount = 1 + (int) std::floor(std::log2((float) std::max(w, h)));
+        pyramid = GlTexture::Create("HiZ pyramid");
+        pyramid.SetBytes(EstimateTextureBytes(GL_R32F, w, h, 1, true));
+        glBindTexture(GL_TEXTURE_2D, pyramid);
+        for (int level = 0; level < levelCount; level++) {
+            levelSizes.push_back(glm::ivec2(w, h));
+            glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, w, h, 0, GL_RED, GL_FLOAT, NULL);
+            if (readLevel < 0 && w <= readbackMaxWidth)
+                readLevel = level;
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+        pyramidFBO = GlFramebuffer::Create("HiZ pyramid FBO");
+        emptyVAO = GlVertexArray::Create("HiZ fullscreen VAO");
+
+        glm::ivec2 readSize = levelSizes[readLevel];
+        readback.resize(readSize.x * readSize.y, 1.0f);
+        for (int i = 0; i < 2; i++) {
+            pixelBuffers[i] = GlBuffer::Create("HiZ readback PBO " + std::to_string(i));
+            GlBufferData(pixelBuffers[i], GL_PIXEL_PACK_BUFFER, readback.size() * sizeof(float), NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // piramida od kopije dubine scene (van renderWidth x renderHeight je 1.0); na kraju je vezan
+    // sourceFBO i vracen viewport. Scena moze da zauzima samo donji levi deo bafera.
+    void Build(unsigned int sourceFBO, unsigned int sceneDepth, Shader &downsampleShader, const glm::mat4 &viewProjection,
+               int renderWidth, int renderHeight) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        glDisable(GL_DEPTH_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, pyramidFBO);
+        glBindVertexArray(emptyVAO);
+        downsampleShader.use();
+        SetInt(downsampleShader, "source", 0);
+        glActiveTexture(GL_TEXTURE0);
+
+        for (int level = 0; level < levelCount; level++) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pyramid, level);
+            glViewport(0, 0, levelSizes[level].x, levelSizes[level].y);
+
+            // nivo koji se cita je iskljucen iz opsega u koji se pise (bez povratne petlje)
+            glm::ivec2 sourceSize = level == 0 ? glm::ivec2(width, height) : levelSizes[level - 1];
+            if (level == 0) {
+                glBindTexture(GL_TEXTURE_2D, sceneDepth);
+            } else {
+                glBindTexture(GL_TEXTURE_2D, pyramid);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+            }
+            glUniform2i(glGetUniformLocation(downsampleShader.ID, "sourceSize"), sourceSize.x, sourceSize.y);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        glBindTexture(GL_TEXTURE_2D, pyramid);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+        // asinhrono citanje grubog nivoa; mapira se tek sledeci frejm
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pyramid, readLevel);
+        glm::ivec2 readSize = levelSizes[readLevel];
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[writeIndex]);
+        glReadPixels(0, 0, readSize.x, readSize.y, GL_RED, GL_FLOAT, (void*)0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pendingViewProjection[writeIndex] = viewProjection;
+        pendingRenderSize[writeIndex] = glm::vec2((float) renderWidth / width, (float) renderHeight / height);
+        pending[writeIndex] = true;
+        writeIndex = 1 - writeIndex;
+
+        glBindVertexArray(0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glBindFramebuffer(GL_FRAMEBUFFER, sourceFBO);
+        if (depthTest)
+            glEnable(GL_DEPTH_TEST);
+    }
+
+    // poziva se na pocetku frejma: preuzima rezultat citanja iz prethodnog frejma
+    void FetchReadback() {
+        int index = writeIndex;
+        if (!pending[index])
+            return;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[index]);
+        const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.size() * sizeof(float), GL_MAP_READ_BIT);
+        if (data) {
+            std::copy((const float *) data, (const float *) data + readback.size(), readback.begin());
+            viewProjection = pendingViewProjection[index];
+            renderScale = pendingRenderSize[index];
+            valid = true;
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending[index] = false;
+    }
+
+    void Invalidate() {
+        valid = false;
+    }
+
+    // true ako je sfera sigurno iza dubine iz prethodnog frejma
+    bool IsOccluded(const glm::vec3 &center, float radius) const {
+        if (!valid)
+            return false;
+
+        glm::vec2 minNdc(1e30f), maxNdc(-1e30f);
+        float minDepth = 1e30f;
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner = center + radius * glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            // presek sa ravni kamere: ne moze pouzdano da se projektuje
+            if (clip.w <= 1e-4f)
+                return false;
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            minNdc = glm::vec2(std::min(minNdc.x, ndc.x), std::min(minNdc.y, ndc.y));
+            maxNdc = glm::vec2(std::max(maxNdc.x, ndc.x), std::max(maxNdc.y, ndc.y));
+            minDepth = std::min(minDepth, ndc.z * 0.5f + 0.5f);
+        }
+        if (maxNdc.x < -1.0f || maxNdc.y < -1.0f || minNdc.x > 1.0f || minNdc.y > 1.0f)
+            return false;
+
+        glm::ivec2 size = levelSizes[readLevel];
+        float scaleX = renderScale.x * size.x, scaleY = renderScale.y * size.y;
+        // pravougaonik se siri za jedan teksel (zaokruzivanje i poravnanje nivoa), da test ostane konzervativan
+        int x0 = glm::clamp((int) std::floor((minNdc.x * 0.5f + 0.5f) * scaleX) - 1, 0, size.x - 1);
+        int x1 = glm::clamp((int) std::floor((maxNdc.x * 0.5f + 0.5f) * scaleX) + 1, 0, size.x - 1);
+        int y0 = glm::clamp((int) std::floor((minNdc.y * 0.5f + 0.5f) * scaleY) - 1, 0, size.y - 1);
+        int y1 = glm::clamp((int) std::floor((maxNdc.y * 0.5f + 0.5f) * scaleY) + 1, 0, size.y - 1);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                if (minDepth <= readback[y * size.x + x])
+                    return false;
+        return true;
+    }
+
+    int LevelCount() const { return levelCount; }
+    int ReadLevel() const { return readLevel; }
+    glm::ivec2 ReadSize() const { return levelSizes[readLevel]; }
+    bool Valid() const { return valid; }
+
+private:
+    int width, height;
+    int levelCount = 0;
+    int readLevel = -1;
+    std::vector<glm::ivec2> levelSizes;
+
+    GlTexture pyramid;
+    GlFramebuffer pyramidFBO;
+    GlVertexArray emptyVAO;
+
+    GlBuffer pixelBuffers[2];
+    glm::mat4 pendingViewProjection[2];
+    glm::vec2 pendingRenderSize[2];
+    bool pending[2] = {false, false};
+    int writeIndex = 0;
+
+    std::vector<float> readback;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    glm::vec2 renderScale = glm::vec2(1.0f);
+    bool valid = false;
+};
+
+// Broj fragmenata koji su prosli test dubine u jednom prolazu (GL_SAMPLES_PASSED).
+// Rezultat se cita iz upita od pre dva frejma, bez cekanja na GPU.
+class SamplesPassedCounter {
+public:
+    SamplesPassedCounter() {
+        for (int i = 0; i < 2; i++)
+            queries[i] = GlQuery::Create("SamplesPassed " + std::to_string(i));
+    }
+
+    void Begin() {
+        glBeginQuery(GL_SAMPLES_PASSED, queries[index]);
+    }
+
+    void End() {
+        glEndQuery(GL_SAMPLES_PASSED);
+        pending[index] = true;
+        index = 1 - index;
+
+        if (pending[index]) {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 samples = 0;
+                glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &samples);
+                result = samples;
+                pending[index] = false;
+            }
+        }
+    }
+
+    uint64_t Result() const { return result; }
+
+private:
+    GlQuery queries[2];
+    bool pending[2] = {false, false};
+    int index = 0;
+    uint64_t result = 0;
+};
+
+#endif
@@ -0,0 +1,539 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+
+#include <gl_resources.h>
+#include <trace.h>
+#include <uniforms.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLES_SSE 1
+#endif
+
+// Cestice za napad (B): bazen u SoA rasporedu (svako polje u svom nizu), pa se integracija,
+// starenje i rampa boje racunaju za 4 cestice odjednom (SSE). Bazen je podeljen na segmente,
+// po jedan za svaku radnu nit; segment sam sabija zive cestice, stvara nove i pise podatke
+// instanci, pa se segmenti salju na GPU kao uzastopni delovi jednog bafera. Crtaju se kao
+// bilbordi jednim instanced pozivom u hdrFBO (aditivno, i u svetlu boju za bloom).
+
+struct ParticleEmitter {
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 1.0f;
+};
+
+struct ParticleSettings {
+    float lifeMin = 0.8f;
+    float lifeMax = 1.6f;
+    float speed = 3.0f;
+    float drag = 0.6f;                              // 1/s, eksponencijalno usporavanje
+    float size = 0.06f;
+    glm::vec3 gravity = glm::vec3(0.0f, 1.5f, 0.0f); // iskre se penju
+    // rampa boje po starosti: belo-zuto -> roze -> tamno ljubicasto (alfa pada do 0)
+    glm::vec3 colors[3] = {glm::vec3(1.0f, 1.0f, 0.6f), glm::vec3(1.0f, 0.2f, 0.9f), glm::vec3(0.3f, 0.0f, 0.5f)};
+};
+
+// statistika poslednjeg frejma
+struct ParticleStats {
+    int alive = 0;
+    int spawned = 0;
+    float simulateMs = 0.0f;
+    float uploadMs = 0.0f;
+    float drawMs = 0.0f;
+};
+
+// radne niti sa fiksnim poslom: nit i uvek obradjuje segment i (render nit radi segment 0)
+class ParticleWorkers {
+public:
+    explicit ParticleWorkers(int count) {
+        for (int i = 1; i < count; i++)
+            threads.emplace_back(&ParticleWorkers::WorkerLoop, this, i);
+    }
+
+    ~ParticleWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    int Count() const {
+        return (int) threads.size() + 1;
+    }
+
+    // job(index) za svaki segment; vraca se kad se svi zavrse
+    void Run(const std::function<void(int)> &job) {
+        if (threads.empty()) {
+            job(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &job;
+            pending = (int) threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        job(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        current = nullptr;
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)> *current = nullptr;
+    unsigned long long generation = 0;
+    int pending = 0;
+    bool stop = false;
+
+    void WorkerLoop(int index) {
+        Tracer::Get().SetThreadName("particle worker " + std::to_string(index));
+        unsigned long long seen = 0;
+        for (;;) {
+            const std::function<void(int)> *job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stop || generation != seen; });
+                if (stop)
+                    return;
+                seen = generation;
+                job = current;
+            }
+            (*job)(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pending == 0)
+                    done.notify_one();
+            }
+        }
+    }
+};
+
+class ParticleSystem {
+public:
+    ParticleSettings settings;
+
+    // budget: najvise zivih cestica; threads: 0 = sve jezgre
+    ParticleSystem(int budget, int threads) {
+        Configure(budget, threads);
+    }
+
+    // nova velicina bazena ili broj niti brise postojece cestice
+    void Configure(int budget, int threads) {
+        if (threads <= 0)
+            threads = (int) std::max(1u, std::thread::hardware_concurrency());
+        budget = std::max(budget, 4);
+        if (budget == this->budget && workers && workers->Count() == threads)
+            return;
+        this->budget = budget;
+        workers.reset(new ParticleWorkers(threads));
+
+        // segmenti pocinju na granici od 4 cestice (SSE blokovi ne prelaze u susedni segment)
+        int perSegment = ((budget + threads - 1) / threads + 3) & ~3;
+        segments.assign(threads, Segment());
+        for (int i = 0; i < threads; i++) {
+            segments[i].begin = i * perSegment;
+            segments[i].capacity = std::max(0, std::min(perSegment, budget - i * perSegment));
+            segments[i].random = 0x9E3779B9u * (i + 1);
+        }
+        capacity = perSegment * threads;
+        for (std::vector<float> *field : {&px, &py, &pz, &vx, &vy, &vz, &age, &invLife})
+            field->assign(capacity, 0.0f);
+        instancePositions.assign((size_t) capacity * 4, 0.0f);
+        instanceColors.assign(capacity, 0);
+        spawnCarry = 0.0f;
+    }
+
+    // do 4 izvora; novi se postavljaju svaki frejm
+    void SetEmitters(const ParticleEmitter *source, int count) {
+        emitterCount = std::min(count, 4);
+        std::copy(source, source + emitterCount, emitters);
+    }
+
+    // emitting: stvaraju se nove cestice tako da ih u ravnotezi bude oko budget
+    void Update(float deltaTime, bool emitting) {
+        auto start = std::chrono::steady_clock::now();
+        int segmentCount = (int) segments.size();
+        int spawnTotal = 0;
+        if (emitting && emitterCount > 0) {
+            spawnCarry += budget / (0.5f * (settings.lifeMin + settings.lifeMax)) * deltaTime;
+            spawnTotal = (int) spawnCarry;
+            spawnCarry -= spawnTotal;
+        } else {
+            spawnCarry = 0.0f;
+        }
+
+        std::function<void(int)> job = [&](int index) {
+            Segment &segment = segments[index];
+            int quota = spawnTotal / segmentCount + (index < spawnTotal % segmentCount ? 1 : 0);
+            segment.count = Simulate(segment.begin, segment.count, deltaTime);
+            segment.spawned = Spawn(segment, quota);
+        };
+        workers->Run(job);
+
+        stats.alive = 0;
+        stats.spawned = 0;
+        for (const Segment &segment : segments) {
+            stats.alive += segment.count;
+            stats.spawned += segment.spawned;
+        }
+        stats.simulateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // cestice sa dugim zivotom, ravnomerno po segmentima (za benchmark)
+    void Fill(int count) {
+        int segmentCount = (int) segments.size();
+        float lifeMin = settings.lifeMin, lifeMax = settings.lifeMax;
+        settings.lifeMin = settings.lifeMax = 1.0e6f;
+        for (int i = 0; i < segmentCount; i++)
+            segments[i].count = 0;
+        for (int i = 0; i < segmentCount; i++)
+            Spawn(segments[i], count / segmentCount + (i < count % segmentCount ? 1 : 0));
+        settings.lifeMin = lifeMin;
+        settings.lifeMax = lifeMax;
+    }
+
+    void Clear() {
+        for (Segment &segment : segments)
+            segment.count = 0;
+        stats.alive = 0;
+    }
+
+    int Alive() const {
+        return stats.alive;
+    }
+
+    int Budget() const {
+        return budget;
+    }
+
+    int Threads() const {
+        return workers->Count();
+    }
+
+    // instance segmenta i: pozicija + velicina (4 float) i RGBA8 boja, od Begin(i), Count(i) komada
+    int SegmentCount() const { return (int) segments.size(); }
+    int SegmentBegin(int i) const { return segments[i].begin; }
+    int SegmentAlive(int i) const { return segments[i].count; }
+    const float *InstancePositions() const { return instancePositions.data(); }
+    const uint32_t *InstanceColors() const { return instanceColors.data(); }
+
+    ParticleStats stats;
+
+private:
+    struct Segment {
+        int begin = 0;
+        int capacity = 0;
+        int count = 0;
+        int spawned = 0;
+        uint32_t random = 1;
+    };
+
+    int budget = 0;
+    int capacity = 0;
+    std::unique_ptr<ParticleWorkers> workers;
+    std::vector<Segment> segments;
+    ParticleEmitter emitters[4];
+    int emitterCount = 0;
+    float spawnCarry = 0.0f;
+
+    // SoA stanje; invLife = 1 / zivot, pa je starost u rampi age * invLife u [0, 1)
+    std::vector<float> px, py, pz, vx, vy, vz, age, invLife;
+    std::vector<float> instancePositions;
+    std::vector<uint32_t> instanceColors;
+
+    static float Random(uint32_t &state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static uint32_t PackColor(float r, float g, float b, float a) {
+        return (uint32_t) (r * 255.0f + 0.5f) | (uint32_t) (g * 255.0f + 0.5f) << 8 |
+               (uint32_t) (b * 255.0f + 0.5f) << 16 | (uint32_t) (a * 255.0f + 0.5f) << 24;
+    }
+
+    // boja i velicina za starost t u [0, 1]
+    void Shade(int index, float t) {
+        const glm::vec3 *c = settings.colors;
+        float a = std::min(2.0f * t, 1.0f), b = std::max(2.0f * t - 1.0f, 0.0f);
+        glm::vec3 color = c[0] + (c[1] - c[0]) * a + (c[2] - c[1]) * b;
+        instanceColors[index] = PackColor(color.r, color.g, color.b, 1.0f - t);
+        float *out = &instancePositions[(size_t) index * 4];
+        out[0] = px[index];
+        out[1] = py[index];
+        out[2] = pz[index];
+        out[3] = settings.size * (1.0f - 0.5f * t);
+    }
+
+    void Move(int from, int to) {
+        px[to] = px[from]; py[to] = py[from]; pz[to] = pz[from];
+        vx[to] = vx[from]; vy[to] = vy[from]; vz[to] = vz[from];
+        age[to] = age[from]; invLife[to] = invLife[from];
+        instancePositions[(size_t) to * 4 + 0] = instancePositions[(size_t) from * 4 + 0];
+        instancePositions[(size_t) to * 4 + 1] = instancePositions[(size_t) from * 4 + 1];
+        instancePositions[(size_t) to * 4 + 2] = instancePositions[(size_t) from * 4 + 2];
+        instancePositions[(size_t) to * 4 + 3] = instancePositions[(size_t) from * 4 + 3];
+        instanceColors[to] = instanceColors[from];
+    }
+
+    // integracija, starenje i rampa za [begin, begin + count); zive se sabijaju na pocetak, vraca broj zivih
+    int Simulate(int begin, int count, float dt) {
+        const float damping = std::exp(-settings.drag * dt);
+        const glm::vec3 gravity = settings.gravity * dt;
+        int i = begin, end = begin + count, write = begin;
+#ifdef PARTICLES_SSE
+        const __m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps(), two = _mm_set1_ps(2.0f);
+        const __m128 dtv = _mm_set1_ps(dt), dampingv = _mm_set1_ps(damping);
+        const __m128 gx = _mm_set1_ps(gravity.x), gy = _mm_set1_ps(gravity.y), gz = _mm_set1_ps(gravity.z);
+        const __m128 size = _mm_set1_ps(settings.size), shrink = _mm_set1_ps(0.5f * settings.size);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const glm::vec3 *c = settings.colors;
+        const __m128 c0[3] = {_mm_set1_ps(c[0].r), _mm_set1_ps(c[0].g), _mm_set1_ps(c[0].b)};
+        const __m128 d01[3] = {_mm_set1_ps(c[1].r - c[0].r), _mm_set1_ps(c[1].g - c[0].g), _mm_set1_ps(c[1].b - c[0].b)};
+        const __m128 d12[3] = {_mm_set1_ps(c[2].r - c[1].r), _mm_set1_ps(c[2].g - c[1].g), _mm_set1_ps(c[2].b - c[1].b)};
+
+        for (; i + 4 <= end; i += 4) {
+            __m128 velX = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&vx[i]), gx), dampingv);
+            __m128 velY = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&vy[i]), gy), dampingv);
+            __m128 velZ = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&vz[i]), gz), dampingv);
+            __m128 posX = _mm_add_ps(_mm_loadu_ps(&px[i]), _mm_mul_ps(velX, dtv));
+            __m128 posY = _mm_add_ps(_mm_loadu_ps(&py[i]), _mm_mul_ps(velY, dtv));
+            __m128 posZ = _mm_add_ps(_mm_loadu_ps(&pz[i]), _mm_mul_ps(velZ, dtv));
+            __m128 ages = _mm_add_ps(_mm_loadu_ps(&age[i]), dtv);
+            __m128 inverse = _mm_loadu_ps(&invLife[i]);
+            __m128 t = _mm_mul_ps(ages, inverse);
+            int mask = _mm_movemask_ps(_mm_cmplt_ps(t, one));
+            if (mask == 0)
+                continue;
+
+            // rampa bez grananja: a raste u prvoj, b u drugoj polovini zivota
+            t = _mm_min_ps(t, one);
+            __m128 a = _mm_min_ps(_mm_mul_ps(t, two), one);
+            __m128 b = _mm_max_ps(_mm_sub_ps(_mm_mul_ps(t, two), one), zero);
+            __m128i packed = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(one, t), scale));
+            packed = _mm_slli_epi32(packed, 24);
+            for (int k = 0; k < 3; k++) {
+                __m128 channel = _mm_add_ps(c0[k], _mm_add_ps(_mm_mul_ps(d01[k], a), _mm_mul_ps(d12[k], b)));
+                packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(channel, scale)), 8 * k));
+            }
+            __m128 sizes = _mm_sub_ps(size, _mm_mul_ps(shrink, t));
+
+            // pozicija + velicina po cestici (transponovanje 4x4)
+            __m128 p0 = posX, p1 = posY, p2 = posZ, p3 = sizes;
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+            if (mask == 0xF) {
+                // sve zive: upis na write <= i ne gazi jos neucitane cestice
+                _mm_storeu_ps(&px[write], posX);
+                _mm_storeu_ps(&py[write], posY);
+                _mm_storeu_ps(&pz[write], posZ);
+                _mm_storeu_ps(&vx[write], velX);
+                _mm_storeu_ps(&vy[write], velY);
+                _mm_storeu_ps(&vz[write], velZ);
+                _mm_storeu_ps(&age[write], ages);
+                _mm_storeu_ps(&invLife[write], inverse);
+                float *out = &instancePositions[(size_t) write * 4];
+                _mm_storeu_ps(out, p0);
+                _mm_storeu_ps(out + 4, p1);
+                _mm_storeu_ps(out + 8, p2);
+                _mm_storeu_ps(out + 12, p3);
+                _mm_storeu_si128((__m128i *) &instanceColors[write], packed);
+                write += 4;
+                continue;
+            }
+
+            // neke su istekle: zive se prepisuju jedna po jedna
+            float lanes[8][4];
+            __m128 rows[4] = {p0, p1, p2, p3};
+            uint32_t colors[4];
+            _mm_storeu_ps(lanes[0], posX);
+            _mm_storeu_ps(lanes[1], posY);
+            _mm_storeu_ps(lanes[2], posZ);
+            _mm_storeu_ps(lanes[3], velX);
+            _mm_storeu_ps(lanes[4], velY);
+            _mm_storeu_ps(lanes[5], velZ);
+            _mm_storeu_ps(lanes[6], ages);
+            _mm_storeu_ps(lanes[7], inverse);
+            _mm_storeu_si128((__m128i *) colors, packed);
+            for (int lane = 0; lane < 4; lane++) {
+                if (!(mask & (1 << lane)))
+                    continue;
+                px[write] = lanes[0][lane]; py[write] = lanes[1][lane]; pz[write] = lanes[2][lane];
+                vx[write] = lanes[3][lane]; vy[write] = lanes[4][lane]; vz[write] = lanes[5][lane];
+                age[write] = lanes[6][lane]; invLife[write] = lanes[7][lane];
+                _mm_storeu_ps(&instancePositions[(size_t) write * 4], rows[lane]);
+                instanceColors[write] = colors[lane];
+                write++;
+            }
+        }
+#endif
+        // ostatak segmenta (ili ceo segment bez SSE)
+        for (; i < end; i++) {
+            vx[i] = (vx[i] + gravity.x) * damping;
+            vy[i] = (vy[i] + gravity.y) * damping;
+            vz[i] = (vz[i] + gravity.z) * damping;
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+            age[i] += dt;
+            float t = age[i] * invLife[i];
+            if (t >= 1.0f)
+                continue;
+            Shade(i, t);
+            if (write != i)
+                Move(i, write);
+            write++;
+        }
+        return write - begin;
+    }
+
+    // nove cestice na kraju segmenta: tacka u sferi izvora, brzina od centra (i malo navise)
+    int Spawn(Segment &segment, int quota) {
+        int count = std::min(quota, segment.capacity - segment.count);
+        for (int n = 0; n < count; n++) {
+            int i = segment.begin + segment.count++;
+            const ParticleEmitter &emitter = emitters[n % std::max(emitterCount, 1)];
+            glm::vec3 direction;
+            float lengthSq;
+            do {
+                direction = glm::vec3(Random(segment.random), Random(segment.random), Random(segment.random)) * 2.0f - 1.0f;
+                lengthSq = glm::dot(direction, direction);
+            } while (lengthSq > 1.0f || lengthSq < 1.0e-4f);
+            glm::vec3 position = emitter.position + direction * emitter.radius;
+            glm::vec3 velocity = (direction / std::sqrt(lengthSq) + glm::vec3(0.0f, 0.5f, 0.0f)) *
+                                 settings.speed * (0.5f + Random(segment.random));
+            px[i] = position.x; py[i] = position.y; pz[i] = position.z;
+            vx[i] = velocity.x; vy[i] = velocity.y; vz[i] = velocity.z;
+            age[i] = 0.0f;
+            invLife[i] = 1.0f / (settings.lifeMin + (settings.lifeMax - settings.lifeMin) * Random(segment.random));
+            Shade(i, 0.0f);
+        }
+        return count;
+    }
+};
+
+// brzina simulacije na CPU za count cestica (bez GPU), u ms po koraku
+struct ParticleBenchmarkResult {
+    int count = 0;
+    int threads = 0;
+    float msPerStep = 0.0f;
+
+    float ParticlesPerMs() const {
+        return msPerStep > 0.0f ? count / msPerStep : 0.0f;
+    }
+};
+
+inline ParticleBenchmarkResult RunParticleBenchmark(int count, int threads, int steps) {
+    TraceZone zone("Particle benchmark", "particles");
+    ParticleSystem system(count, threads);
+    ParticleEmitter emitter;
+    system.SetEmitters(&emitter, 1);
+    system.Fill(count);
+    system.Update(1.0f / 60.0f, false);
+
+    ParticleBenchmarkResult result;
+    result.count = count;
+    result.threads = system.Threads();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++)
+        system.Update(1.0f / 60.0f, false);
+    result.msPerStep = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / steps;
+    return result;
+}
+
+// instance na GPU: dva niza (pozicija + velicina, RGBA8 boja), segmenti se upisuju jedan za drugim
+class ParticleRenderer {
+public:
+    ParticleRenderer() {
+        vertexArray = GlVertexArray::Create("particle VAO");
+        positionBuffer = GlBuffer::Create("particle positions");
+        colorBuffer = GlBuffer::Create("particle colors");
+        glBindVertexArray(vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *) 0);
+        glVertexAttribDivisor(0, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, colorBuffer);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(uint32_t), (void *) 0);
+        glVertexAttribDivisor(1, 1);
+        glBindVertexArray(0);
+    }
+
+    // bafer se svaki frejm napusta (orphaning), pa upis ne ceka na crtanje prethodnog frejma
+    void Upload(ParticleSystem &system) {
+        auto start = std::chrono::steady_clock::now();
+        count = system.Alive();
+        if (system.Budget() != capacity) {
+            capacity = system.Budget();
+            positionBuffer.SetBytes((size_t) capacity * 4 * sizeof(float));
+            colorBuffer.SetBytes((size_t) capacity * sizeof(uint32_t));
+        }
+        if (count > 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+            glBufferData(GL_ARRAY_BUFFER, (size_t) capacity * 4 * sizeof(float), NULL, GL_STREAM_DRAW);
+            for (int i = 0, offset = 0; i < system.SegmentCount(); offset += system.SegmentAlive(i), i++)
+                glBufferSubData(GL_ARRAY_BUFFER, (size_t) offset * 4 * sizeof(float),
+                                (size_t) system.SegmentAlive(i) * 4 * sizeof(float),
+                                system.InstancePositions() + (size_t) system.SegmentBegin(i) * 4);
+            glBindBuffer(GL_ARRAY_BUFFER, colorBuffer);
+            glBufferData(GL_ARRAY_BUFFER, (size_t) capacity * sizeof(uint32_t), NULL, GL_STREAM_DRAW);
+            for (int i = 0, offset = 0; i < system.SegmentCount(); offset += system.SegmentAlive(i), i++)
+                glBufferSubData(GL_ARRAY_BUFFER, (size_t) offset * sizeof(uint32_t),
+                                (size_t) system.SegmentAlive(i) * sizeof(uint32_t),
+                                system.InstanceColors() + system.SegmentBegin(i));
+        }
+        system.stats.uploadMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // aditivno, bez upisa dubine (redosled nije bitan); posle poziva je vraceno uobicajeno stanje
+    void Draw(Shader &shader, const glm::mat4 &projection, const glm::mat4 &view, float intensity) {
+        if (count == 0)
+            return;
+        shader.use();
+        SetMat4(shader, "projection", projection);
+        SetMat4(shader, "view", view);
+        SetFloat(shader, "intensity", intensity);
+        glBlendFunc(GL_ONE, GL_ONE);
+        glDepthMask(GL_FALSE);
+        glBindVertexArray(vertexArray);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        glBindVertexArray(0);
+        glDepthMask(GL_TRUE);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+private:
+    GlVertexArray vertexArray;
+    GlBuffer positionBuffer;
+    GlBuffer colorBuffer;
+    int capacity = 0;
+    int count = 0;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef SCENE_DEPTH_H
+#define SCENE_DEPTH_H
+
+#include <glad/glad.h>
+
+#include <gl_resources.h>
+
+// Kopija dubine scene za uzorkovanje (renderbuffer hdrFBO-a se ne moze citati u shaderu).
+// Format je isti kao u hdrFBO (DEPTH24_STENCIL8, blit dubine trazi iste formate); sampler2D
+// vraca dubinu.
+//
+// Pravi se jednom po frejmu, posle neprozirnog prolaza, i istu teksturu koriste Hi-Z
+// piramida, razresavanje senki i TAA resolve. Oblaci se crtaju kasnije, pa TAA za njihove
+// piksele reprojektuje dubinu onoga sto je iza njih (okretanje kamere je i dalje tacno).
+
+class SceneDepthCopy {
+public:
+    SceneDepthCopy(int width, int height) {
+        texture = GlTexture::Create("scene depth copy");
+        texture.SetBytes(EstimateTextureBytes(GL_DEPTH24_STENCIL8, width, height));
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        fbo = GlFramebuffer::Create("scene depth copy FBO");
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // van donjeg levog dela (renderWidth x renderHeight) ostaje dubina 1.0; na kraju je vezan sourceFBO
+    void Copy(unsigned int sourceFBO, int renderWidth, int renderHeight) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, sourceFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, renderWidth, renderHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, sourceFBO);
+    }
+
+    unsigned int Texture() const {
+        return texture;
+    }
+
+private:
+    GlTexture texture;
+    GlFramebuffer fbo;
+};
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef SHADOWS_H
+#define SHADOWS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/shader.h>
+
+#include <gl_resources.h>
+#include <gpu_timer.h>
+#include <uniforms.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Kaskadne mape senki za usmereno svetlo, sa kesom statickih bacaca senke.
+//
+// Svaka kaskada pokriva sferu oko kamere (do svoje granice udaljenosti), uvecanu za marginu.
+// Staticki bacaci (podloge, nepokretne kocke, stress scena) se crtaju u poseban sloj niza
+// samo kada kamera izadje iz tog regiona ili se promeni skup statickih objekata; svaki
+// frejm se staticki sloj kopira (blit dubine) u mapu senki i preko njega se crtaju samo
+// pokretni objekti (modeli i svetlece kocke). Region zavisi samo od polozaja kamere, pa
+// okretanje kamere ne brise kes, a centar je poravnat na teksel da senke ne trepere.
+//
+// Shaderi scene ne uzorkuju senke, pa se one nanose posle neprozirnog prolaza: iz dubine
+// scene se rekonstruise polozaj, bira kaskada po udaljenosti od kamere, a boja (i svetla
+// boja za bloom) se mnozi faktorom vidljivosti (PCF 3x3) umanjenim za jacinu senke.
+// Pikseli sa zadatom stencil vrednoscu (izvori svetla) se preskacu.
+
+struct ShadowCascade {
+    glm::mat4 lightViewProjection = glm::mat4(1.0f);
+    glm::vec3 regionCenter = glm::vec3(0.0f);   // u prostoru svetla
+    float regionRadius = 0.0f;
+    float splitFar = 0.0f;                      // udaljenost od kamere do koje se kaskada koristi
+    bool valid = false;
+    bool rebuild = false;
+    unsigned int rebuilds = 0;
+};
+
+class CascadedShadowMaps {
+public:
+    static const int cascadeCount = 3;
+
+    // koliko ispred regiona (prema svetlu) jos mogu da budu bacaci senke
+    float casterDistance = 100.0f;
+    // 0 = jednake kaskade, 1 = logaritamska podela
+    float splitLambda = 0.75f;
+
+    // statistika poslednjeg frejma i usrednjeno vreme po rezimu
+    float gpuMs = 0.0f;
+    float cpuMs = 0.0f;
+    float cachedGpuMs = 0.0f;
+    float uncachedGpuMs = 0.0f;
+    unsigned int staticRenders = 0;     // kaskade ciji su staticki bacaci crtani u ovom frejmu
+
+    explicit CascadedShadowMaps(int resolution = 1024)
+            : resolution(resolution), timer("shadow maps") {
+        CreateArray(staticDepth, "shadow static casters", false);
+        CreateArray(shadowDepth, "shadow maps", true);
+        staticFBO = GlFramebuffer::Create("shadow static casters FBO");
+        shadowFBO = GlFramebuffer::Create("shadow maps FBO");
+        for (GLuint fbo : {staticFBO.Id(), shadowFBO.Id()}) {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+
+        emptyVAO = GlVertexArray::Create("shadow resolve VAO");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void SetLight(const glm::vec3 &direction) {
+        lightDirection = glm::normalize(direction);
+        lightView = glm::lookAt(glm::vec3(0.0f), lightDirection, glm::vec3(0.0f, 1.0f, 0.0f));
+        Invalidate();
+    }
+
+    void Invalidate() {
+        for (ShadowCascade &cascade : cascades)
+            cascade.valid = false;
+    }
+
+    const ShadowCascade &Cascade(int index) const {
+        return cascades[index];
+    }
+
+    int Resolution() const {
+        return resolution;
+    }
+
+    // granice kaskada i regioni; kaskada se obnavlja ako kamera izadje iz regiona ili se promeni staticka scena
+    void Fit(const glm::vec3 &cameraPosition, float nearPlane, float shadowDistance, float margin, bool cacheEnabled,
+             uint64_t staticSignature) {
+        // bez kesa staticki slojevi nisu azurni, pa se po ukljucivanju pune ponovo
+        if (staticSignature != lastStaticSignature || !cacheEnabled || !wasCached)
+            Invalidate();
+        lastStaticSignature = staticSignature;
+        wasCached = cacheEnabled;
+
+        glm::vec3 camera = glm::vec3(lightView * glm::vec4(cameraPosition, 1.0f));
+        for (int i = 0; i < cascadeCount; i++) {
+            ShadowCascade &cascade = cascades[i];
+            float fraction = (float) (i + 1) / cascadeCount;
+            float logarithmic = nearPlane * std::pow(shadowDistance / nearPlane, fraction);
+            float uniform = nearPlane + (shadowDistance - nearPlane) * fraction;
+            cascade.splitFar = splitLambda * logarithmic + (1.0f - splitLambda) * uniform;
+
+            cascade.rebuild = !cascade.valid || glm::length(camera - cascade.regionCenter) + cascade.splitFar > cascade.regionRadius;
+            if (!cascade.rebuild)
+                continue;
+
+            float radius = cascade.splitFar * (1.0f + std::max(margin, 0.0f));
+            float texel = 2.0f * radius / resolution;
+            glm::vec3 center = glm::vec3(std::floor(camera.x / texel) * texel, std::floor(camera.y / texel) * texel, camera.z);
+            // svetlo gleda niz -z: dubina centra je -center.z
+            float depth = -center.z;
+            glm::mat4 projection = glm::ortho(center.x - radius, center.x + radius, center.y - radius, center.y + radius,
+                                              depth - radius - casterDistance, depth + radius);
+            cascade.lightViewProjection = projection * lightView;
+            cascade.regionCenter = center;
+            cascade.regionRadius = radius;
+            cascade.valid = true;
+            cascade.rebuilds++;
+        }
+    }
+
+    // drawStatic/drawDynamic crtaju dubinu bacaca senke sa zadatom matricom svetla
+    void Render(bool cacheEnabled, const std::function<void(const glm::mat4 &)> &drawStatic,
+                const std::function<void(const glm::mat4 &)> &drawDynamic) {
+        auto start = std::chrono::steady_clock::now();
+        timer.Begin();
+        GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+        glViewport(0, 0, resolution, resolution);
+
+        staticRenders = 0;
+        for (int i = 0; i < cascadeCount; i++) {
+            ShadowCascade &cascade = cascades[i];
+            glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowDepth, 0, i);
+            if (cacheEnabled) {
+                if (cascade.rebuild) {
+                    glBindFramebuffer(GL_FRAMEBUFFER, staticFBO);
+                    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepth, 0, i);
+                    glClear(GL_DEPTH_BUFFER_BIT);
+                    drawStatic(cascade.lightViewProjection);
+                    staticRenders++;
+                }
+                // kopija kesiranog sloja, pa pokretni objekti preko nje (GL_LESS: ostaje blizi bacac)
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFBO);
+                glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepth, 0, i);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, shadowFBO);
+                glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+                glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
+            } else {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                drawStatic(cascade.lightViewProjection);
+                staticRenders++;
+            }
+            drawDynamic(cascade.lightViewProjection);
+            cascade.rebuild = false;
+        }
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        if (cullFace)
+            glEnable(GL_CULL_FACE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        timer.End();
+
+        cpuMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        gpuMs = timer.Milliseconds();
+        float &average = cacheEnabled ? cachedGpuMs : uncachedGpuMs;
+        average = average == 0.0f ? gpuMs : average * 0.95f + gpuMs * 0.05f;
+    }
+
+    // senke u sceneFBO (boja i svetla boja) prema kopiji dubine scene (scene_depth.h), osim na pikselima ciji je
+    // stencil skipStencil; na kraju je vezan sceneFBO, a viewport ostaje isti. Scena moze da zauzima samo donji
+    // levi deo (renderWidth x renderHeight).
+    void Resolve(unsigned int sceneFBO, unsigned int sceneDepth, int renderWidth, int renderHeight, Shader &resolveShader,
+                 const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition, float strength, int skipStencil) {
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_NOTEQUAL, skipStencil, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        glDisable(GL_DEPTH_TEST);
+        glDepthMask(GL_FALSE);
+        glBlendFunc(GL_ZERO, GL_SRC_COLOR);
+
+        glm::mat4 matrices[cascadeCount];
+        float splits[cascadeCount], texels[cascadeCount];
+        for (int i = 0; i < cascadeCount; i++) {
+            matrices[i] = cascades[i].lightViewProjection;
+            splits[i] = cascades[i].splitFar;
+            texels[i] = 2.0f * cascades[i].regionRadius / resolution;
+        }
+        resolveShader.use();
+        SetInt(resolveShader, "sceneDepth", 0);
+        SetInt(resolveShader, "shadowMap", 1);
+        SetMat4(resolveShader, "inverseViewProjection", glm::inverse(viewProjection));
+        SetVec3(resolveShader, "cameraPosition", cameraPosition);
+        SetFloat(resolveShader, "strength", strength);
+        glUniform2f(glGetUniformLocation(resolveShader.ID, "renderSize"), (float) renderWidth, (float) renderHeight);
+        glUniformMatrix4fv(glGetUniformLocation(resolveShader.ID, "lightViewProjection"), cascadeCount, GL_FALSE,
+                           glm::value_ptr(matrices[0]));
+        glUniform1fv(glGetUniformLocation(resolveShader.ID, "cascadeFar"), cascadeCount, splits);
+        glUniform1fv(glGetUniformLocation(resolveShader.ID, "texelWorld"), cascadeCount, texels);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, sceneDepth);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadowDepth);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_STENCIL_TEST);
+        glDepthMask(GL_TRUE);
+        if (depthTest)
+            glEnable(GL_DEPTH_TEST);
+    }
+
+private:
+    const int resolution;
+    ShadowCascade cascades[cascadeCount];
+    glm::vec3 lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+    glm::mat4 lightView = glm::mat4(1.0f);
+    uint64_t lastStaticSignature = 0;
+    bool wasCached = false;
+
+    GlTexture staticDepth;
+    GlTexture shadowDepth;
+    GlFramebuffer staticFBO;
+    GlFramebuffer shadowFBO;
+    GlVertexArray emptyVAO;
+    GpuIntervalTimer timer;
+
+    void CreateArray(GlTexture &texture, const std::string &label, bool compare) {
+        texture = GlTexture::Create(label);
+        texture.SetBytes(EstimateTextureBytes(GL_DEPTH_COMPONENT24, resolution, resolution, cascadeCount));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, cascadeCount, 0,
+                     GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        float border[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+        if (compare) {
+            // hardverski PCF: sampler2DArrayShadow vraca udeo osvetljenih uzoraka
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef TEMPORAL_H
+#define TEMPORAL_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+
+#include <gl_resources.h>
+#include <uniforms.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// Temporal upscaling: 3D prolazi se crtaju u donji levi deo hdrFBO u internoj rezoluciji
+// (50-100%), sa projekcijom pomerenom za deo piksela (Halton 2,3). Resolve prolaz spaja
+// tekuci frejm sa istorijom u punoj rezoluciji: vektor kretanja se dobija reprojekcijom
+// dubine matricom prethodnog frejma, a istorija se ogranicava na opseg boja iz 3x3 okoline
+// tekuceg piksela (u YCoCg), sto uklanja duhove pokretnih objekata.
+
+inline float Halton(int index, int base) {
+    float result = 0.0f;
+    float fraction = 1.0f / base;
+    while (index > 0) {
+        result += fraction * (index % base);
+        index /= base;
+        fraction /= base;
+    }
+    return result;
+}
+
+class TemporalUpscaler {
+public:
+    static const int jitterPhases = 8;
+
+    // udeo tekuceg frejma je 1 - feedback
+    float feedback = 0.9f;
+
+    TemporalUpscaler(int width, int height)
+            : width(width), height(height) {
+        brightTexture = GlTexture::Create("TAA bright upscaled");
+        brightTexture.SetBytes(EstimateTextureBytes(GL_RGBA16F, width, height));
+        glBindTexture(GL_TEXTURE_2D, brightTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+        SetSampling(GL_LINEAR);
+
+        // istorija je ping-pong par; svaki FBO pise i uvecanu svetlu boju za bloom
+        unsigned int attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        for (int i = 0; i < 2; i++) {
+            history[i] = GlTexture::Create("TAA history[" + std::to_string(i) + "]");
+            history[i].SetBytes(EstimateTextureBytes(GL_RGBA16F, width, height));
+            glBindTexture(GL_TEXTURE_2D, history[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+            SetSampling(GL_LINEAR);
+
+            resolveFBO[i] = GlFramebuffer::Create("TAA resolve FBO[" + std::to_string(i) + "]");
+            glBindFramebuffer(GL_FRAMEBUFFER, resolveFBO[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, history[i], 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, brightTexture, 0);
+            glDrawBuffers(2, attachments);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                std::cout << "Framebuffer not complete!" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // poziva se na pocetku frejma: interna rezolucija i jitter za ovaj frejm
+    void BeginFrame(float scale) {
+        scale = glm::clamp(scale, 0.5f, 1.0f);
+        renderWidth = std::max(1, (int) (width * scale + 0.5f));
+        renderHeight = std::max(1, (int) (height * scale + 0.5f));
+        frameIndex++;
+        int phase = frameIndex % jitterPhases + 1;
+        jitter = glm::vec2(Halton(phase, 2) - 0.5f, Halton(phase, 3) - 0.5f);
+    }
+
+    // pomeraj projekcije za jitter (u pikselima interne rezolucije); slika se pomera za -jitter
+    glm::mat4 JitterProjection(const glm::mat4 &projection) const {
+        glm::mat4 jittered = projection;
+        jittered[2][0] += jitter.x * 2.0f / renderWidth;
+        jittered[2][1] += jitter.y * 2.0f / renderHeight;
+        return jittered;
+    }
+
+    // viewProjection je bez jittera, sceneDepth je kopija dubine frejma (scene_depth.h); posle poziva
+    // je vezan izlazni FBO sa viewportom pune rezolucije
+    void Resolve(unsigned int sceneDepth, Shader &resolveShader, unsigned int sceneColor, unsigned int brightColor,
+                 const glm::mat4 &viewProjection, void (*drawQuad)()) {
+        current = 1 - current;
+        glBindFramebuffer(GL_FRAMEBUFFER, resolveFBO[current]);
+        glViewport(0, 0, width, height);
+
+        resolveShader.use();
+        SetInt(resolveShader, "scene", 0);
+        SetInt(resolveShader, "bright", 1);
+        SetInt(resolveShader, "depth", 2);
+        SetInt(resolveShader, "history", 3);
+        glUniform2f(glGetUniformLocation(resolveShader.ID, "renderScale"),
+                    (float) renderWidth / width, (float) renderHeight / height);
+        glUniform2f(glGetUniformLocation(resolveShader.ID, "texelSize"), 1.0f / width, 1.0f / height);
+        glUniform2f(glGetUniformLocation(resolveShader.ID, "jitter"), jitter.x / width, jitter.y / height);
+        SetMat4(resolveShader, "inverseViewProjection", glm::inverse(viewProjection));
+        SetMat4(resolveShader, "previousViewProjection", previousViewProjection);
+        SetInt(resolveShader, "historyValid", historyValid);
+        SetFloat(resolveShader, "feedback", feedback);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, sceneColor);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, brightColor);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, sceneDepth);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, history[1 - current]);
+        glActiveTexture(GL_TEXTURE0);
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        glDisable(GL_DEPTH_TEST);
+        drawQuad();
+        if (depthTest)
+            glEnable(GL_DEPTH_TEST);
+
+        previousViewProjection = viewProjection;
+        historyValid = true;
+    }
+
+    // istorija se odbacuje kada se upscaling iskljuci
+    void Reset() {
+        historyValid = false;
+    }
+
+    unsigned int Output() const { return history[current]; }
+    unsigned int Bright() const { return brightTexture; }
+    glm::ivec2 RenderSize() const { return glm::ivec2(renderWidth, renderHeight); }
+    glm::vec2 Jitter() const { return jitter; }
+
+private:
+    int width, height;
+    int renderWidth = 0, renderHeight = 0;
+    int frameIndex = 0;
+    glm::vec2 jitter = glm::vec2(0.0f);
+
+    GlTexture brightTexture;
+    GlTexture history[2];
+    GlFramebuffer resolveFBO[2];
+    int current = 0;
+    glm::mat4 previousViewProjection = glm::mat4(1.0f);
+    bool historyValid = false;
+
+    static void SetSampling(GLint filter) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+};
+
+// Skala interne rezolucije prema izmerenom vremenu frejma na GPU. Broj piksela raste sa
+// kvadratom skale, pa se skala menja sa korenom odnosa ciljnog i izmerenog vremena.
+struct DynamicResolution {
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    // mrtva zona oko cilja i brzina priblizavanja (da skala ne osciluje iz frejma u frejm)
+    float deadband = 0.05f;
+    float smoothing = 0.15f;
+
+    float Update(float scale, float frameMs, float targetMs) const {
+        if (frameMs <= 0.0f || targetMs <= 0.0f)
+            return scale;
+        float ratio = targetMs / frameMs;
+        if (std::fabs(ratio - 1.0f) < deadband)
+            return scale;
+        float desired = glm::clamp(scale * std::sqrt(ratio), minScale, maxScale);
+        return glm::clamp(scale + (desired - scale) * smoothing, minScale, maxScale);
+    }
+};
+
+#endif
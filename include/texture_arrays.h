@@ -0,0 +1,183 @@
+#ifndef TEXTURE_ARRAYS_H
+#define TEXTURE_ARRAYS_H
+
+#include <glad/glad.h>
+
+#include <gl_resources.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Teksture materijala spakovane u GL_TEXTURE_2D_ARRAY stranice. Sve teksture iste velicine
+// i formata dele stranicu (RGBA8 ili SRGB8_ALPHA8, sa mipmapama), pa materijal postaje par indeksa sloja u podacima
+// crtanja, a vise mreza i materijala se crta bez ijedne promene vezane teksture.
+//
+// Velicina se odredjuje na radnoj niti pri importu: ako je dozvoljeno, slika se skalira na
+// kvadrat stepena dvojke, da bi sto vise tekstura zavrsilo u istoj stranici.
+
+struct TextureLayer {
+    int page = -1;
+    int layer = 0;
+
+    bool Valid() const { return page >= 0; }
+};
+
+// RGBA8 kopija slike u velicini sloja (bilinearno skaliranje)
+inline std::vector<unsigned char> ResampleRgba(const unsigned char *source, int width, int height, int components,
+                                               int targetWidth, int targetHeight) {
+    std::vector<unsigned char> result((size_t) targetWidth * targetHeight * 4);
+    auto texel = [&](int x, int y, int channel) -> float {
+        const unsigned char *p = source + ((size_t) y * width + x) * components;
+        switch (components) {
+            case 1: return channel == 3 ? 255.0f : p[0];
+            case 2: return channel == 3 ? p[1] : p[0];
+            case 3: return channel == 3 ? 255.0f : p[channel];
+            default: return p[channel];
+        }
+    };
+
+    for (int y = 0; y < targetHeight; y++) {
+        float sy = std::max(0.0f, (y + 0.5f) * height / targetHeight - 0.5f);
+        int y0 = std::min((int) sy, height - 1), y1 = std::min(y0 + 1, height - 1);
+        float fy = sy - y0;
+        for (int x = 0; x < targetWidth; x++) {
+            float sx = std::max(0.0f, (x + 0.5f) * width / targetWidth - 0.5f);
+            int x0 = std::min((int) sx, width - 1), x1 = std::min(x0 + 1, width - 1);
+            float fx = sx - x0;
+            unsigned char *out = &result[((size_t) y * targetWidth + x) * 4];
+            for (int c = 0; c < 4; c++) {
+                float top = texel(x0, y0, c) * (1.0f - fx) + texel(x1, y0, c) * fx;
+                float bottom = texel(x0, y1, c) * (1.0f - fx) + texel(x1, y1, c) * fx;
+                out[c] = (unsigned char) (top * (1.0f - fy) + bottom * fy + 0.5f);
+            }
+        }
+    }
+    return result;
+}
+
+class TextureArrayManager {
+public:
+    // skaliranje na kvadrat stepena dvojke u opsegu [minLayerSize, maxLayerSize]
+    bool allowResize = true;
+    int minLayerSize = 64;
+    int maxLayerSize = 1024;
+    int initialLayers = 4;
+
+    struct Page {
+        GlTexture texture;
+        int width = 0;
+        int height = 0;
+        int levels = 1;
+        int used = 0;
+        int capacity = 0;
+        bool srgb = false;
+        bool dirty = false;
+    };
+
+    // velicina sloja za sliku; poziva se na radnoj niti
+    void LayerSize(int width, int height, int &layerWidth, int &layerHeight) const {
+        if (!allowResize) {
+            layerWidth = width;
+            layerHeight = height;
+            return;
+        }
+        int size = minLayerSize;
+        while (size < std::max(width, height) && size < maxLayerSize)
+            size *= 2;
+        layerWidth = layerHeight = size;
+    }
+
+    // render nit: slobodan sloj u stranici odgovarajuce velicine i formata (stranica raste po potrebi)
+    TextureLayer Allocate(int width, int height, bool srgb = false) {
+        int pageIndex = -1;
+        for (int i = 0; i < (int) pages.size(); i++)
+            if (pages[i].width == width && pages[i].height == height && pages[i].srgb == srgb) {
+                pageIndex = i;
+                break;
+            }
+        if (pageIndex < 0) {
+            pages.emplace_back();
+            pageIndex = (int) pages.size() - 1;
+            Page &page = pages.back();
+            page.width = width;
+            page.height = height;
+            page.srgb = srgb;
+            page.levels = 1;
+            while ((std::max(width, height) >> page.levels) > 0)
+                page.levels++;
+            Reallocate(pageIndex, initialLayers);
+        }
+
+        Page &page = pages[pageIndex];
+        if (page.used == page.capacity)
+            Reallocate(pageIndex, page.capacity * 2);
+
+        TextureLayer layer;
+        layer.page = pageIndex;
+        layer.layer = page.used++;
+        return layer;
+    }
+
+    // deo redova sloja (RGBA8); mipmape se prave u GenerateMipmaps
+    void UploadRows(const TextureLayer &layer, int firstRow, int rows, const unsigned char *pixels) {
+        Page &page = pages[layer.page];
+        glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, firstRow, layer.layer, page.width, rows, 1,
+                        GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        page.dirty = true;
+    }
+
+    // mipmape svih stranica u koje je nesto upisano (jednom po ucitanom modelu)
+    void GenerateMipmaps() {
+        for (Page &page : pages) {
+            if (!page.dirty)
+                continue;
+            glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            page.dirty = false;
+        }
+    }
+
+    unsigned int PageTexture(int page) const {
+        return page >= 0 && page < (int) pages.size() ? pages[page].texture.Id() : 0;
+    }
+
+    const std::vector<Page> &Pages() const {
+        return pages;
+    }
+
+private:
+    std::vector<Page> pages;
+
+    // nova stranica veceg kapaciteta; postojeci slojevi se kopiraju na GPU (GL 4.3)
+    void Reallocate(int pageIndex, int capacity) {
+        Page &page = pages[pageIndex];
+        GLenum format = page.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        GlTexture texture = GlTexture::Create("texture array " + std::to_string(page.width) + "x" +
+                                              std::to_string(page.height) + (page.srgb ? " sRGB" : "") +
+                                              " #" + std::to_string(pageIndex));
+        texture.SetBytes(EstimateTextureBytes(format, page.width, page.height, capacity, true));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        for (int level = 0; level < page.levels; level++)
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, std::max(1, page.width >> level),
+                         std::max(1, page.height >> level), capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        if (page.used > 0)
+            for (int level = 0; level < page.levels; level++)
+                glCopyImageSubData(page.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   std::max(1, page.width >> level), std::max(1, page.height >> level), page.used);
+
+        page.texture = std::move(texture);
+        page.capacity = capacity;
+    }
+};
+
+#endif
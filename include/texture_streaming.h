@@ -0,0 +1,547 @@
+#ifndef TEXTURE_STREAMING_H
+#define TEXTURE_STREAMING_H
+
+#include <glad/glad.h>
+
+#include <stb_image.h>
+
+#include <gl_resources.h>
+#include <trace.h>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Strimovanje tekstura po mip nivoima.
+//
+// Pri prvom ucitavanju slika se dekodira jednom, pravi se ceo lanac mipmapa (RGBA8) i cuva
+// na disku pod hesom sadrzaja fajla; posle toga se svaki nivo cita direktno iz kesa. Na GPU
+// je od pocetka samo rep lanca (nivoi do tailSize piksela), a detaljniji nivoi se ucitavaju
+// na radnim nitima, jedan po jedan, prema velicini objekta na ekranu. GL tekstura je uvek
+// ista (meshevi cuvaju njen id): nivoi se definisu pojedinacno, a GL_TEXTURE_BASE_LEVEL
+// pokazuje na najdetaljniji rezidentan nivo. Kada bi novi nivo presao budzet, izbacuju se
+// najdetaljniji nivoi tekstura koje najduze nisu trazene (LRU); nivoi potrebni u tekucem
+// frejmu se ne izbacuju.
+
+namespace streaming {
+
+struct MipLevel {
+    int width = 0;
+    int height = 0;
+    size_t offset = 0;      // u fajlu kesa
+    size_t bytes = 0;
+};
+
+// kes na disku i rep lanca mipmapa (pripremljen na radnoj niti)
+struct TextureSource {
+    std::string path;
+    std::string cachePath;
+    std::vector<MipLevel> levels;
+    int tailLevel = 0;
+    std::vector<unsigned char> tail;    // nivoi [tailLevel, levels.size()) redom
+
+    bool Valid() const {
+        return !levels.empty();
+    }
+};
+
+const uint32_t cacheMagic = 0x3150494D;    // "MIP1"
+const size_t headerBytes = 4 * sizeof(uint32_t);
+
+inline uint64_t HashFile(const std::string &path, bool &ok) {
+    std::ifstream in(path, std::ios::binary);
+    ok = (bool) in;
+    uint64_t hash = 1469598103934665603ull;
+    std::vector<char> buffer(64 * 1024);
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        for (std::streamsize i = 0; i < in.gcount(); i++) {
+            hash ^= (unsigned char) buffer[i];
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+inline std::vector<MipLevel> MipLayout(int width, int height) {
+    std::vector<MipLevel> levels;
+    size_t offset = headerBytes;
+    while (true) {
+        MipLevel level;
+        level.width = width;
+        level.height = height;
+        level.offset = offset;
+        level.bytes = (size_t) width * height * 4;
+        levels.push_back(level);
+        offset += level.bytes;
+        if (width == 1 && height == 1)
+            break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return levels;
+}
+
+// 2x2 usrednjavanje (neparna ivica ponavlja poslednji red/kolonu)
+inline void Downsample(const unsigned char *source, int width, int height, unsigned char *target, int targetWidth,
+                       int targetHeight) {
+    for (int y = 0; y < targetHeight; y++) {
+        int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < targetWidth; x++) {
+            int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < 4; c++) {
+                int sum = source[((size_t) y0 * width + x0) * 4 + c] + source[((size_t) y0 * width + x1) * 4 + c] +
+                          source[((size_t) y1 * width + x0) * 4 + c] + source[((size_t) y1 * width + x1) * 4 + c];
+                target[((size_t) y * targetWidth + x) * 4 + c] = (unsigned char) ((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+// kes se pise u privremeni fajl i tek kada je ceo upisan preimenuje, pa prekinut upis ne ostavlja
+// fajl koji izgleda ispravno
+inline bool BuildCache(const std::string &path, const std::string &cachePath) {
+    TraceZone zone("Build mip cache", "streaming");
+    int width, height, components;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &components, 4);
+    if (!data) {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        return false;
+    }
+
+    std::string temporaryPath = cachePath + ".tmp";
+    std::ofstream out(temporaryPath, std::ios::binary);
+    std::vector<MipLevel> levels = MipLayout(width, height);
+    uint32_t header[4] = {cacheMagic, (uint32_t) width, (uint32_t) height, (uint32_t) levels.size()};
+    out.write((const char *) header, sizeof(header));
+    out.write((const char *) data, levels[0].bytes);
+
+    std::vector<unsigned char> previous(data, data + levels[0].bytes), next;
+    stbi_image_free(data);
+    for (size_t i = 1; i < levels.size(); i++) {
+        next.resize(levels[i].bytes);
+        Downsample(previous.data(), levels[i - 1].width, levels[i - 1].height, next.data(), levels[i].width,
+                   levels[i].height);
+        out.write((const char *) next.data(), next.size());
+        previous.swap(next);
+    }
+    out.close();
+    if (!out) {
+        std::cout << "Mip cache could not be written: " << temporaryPath << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    // rename ne zamenjuje postojeci fajl na svim platformama
+    std::remove(cachePath.c_str());
+    if (std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+inline size_t FileSize(const std::string &path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in ? (size_t) in.tellg() : 0;
+}
+
+inline bool ReadRange(const std::string &cachePath, size_t offset, size_t bytes, std::vector<unsigned char> &out) {
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in)
+        return false;
+    out.resize(bytes);
+    in.seekg((std::streamoff) offset);
+    in.read((char *) out.data(), (std::streamsize) bytes);
+    return (size_t) in.gcount() == bytes;
+}
+
+// kes (pravi se ako ne postoji, ako mu zaglavlje nije ispravno ili mu velicina ne odgovara
+// zaglavlju) i rep lanca do tailSize piksela
+inline bool PrepareSource(const std::string &path, int tailSize, const std::string &cacheDirectory, TextureSource &out) {
+    TraceZone zone("Prepare streamed texture", "streaming");
+    bool ok = false;
+    uint64_t hash = HashFile(path, ok);
+    if (!ok) {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        return false;
+    }
+    char name[64];
+    std::snprintf(name, sizeof(name), "mip_cache_%016llx.bin", (unsigned long long) hash);
+    out.path = path;
+    out.cachePath = cacheDirectory + name;
+
+    std::vector<unsigned char> header;
+    const uint32_t *fields = nullptr;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (ReadRange(out.cachePath, 0, headerBytes, header)) {
+            fields = (const uint32_t *) header.data();
+            if (fields[0] == cacheMagic && fields[1] > 0 && fields[2] > 0) {
+                std::vector<MipLevel> levels = MipLayout(fields[1], fields[2]);
+                if (levels.size() == fields[3] && FileSize(out.cachePath) == levels.back().offset + levels.back().bytes)
+                    break;
+            }
+        }
+        fields = nullptr;
+        if (attempt == 0 && !BuildCache(path, out.cachePath))
+            return false;
+    }
+    if (!fields)
+        return false;
+
+    out.levels = MipLayout(fields[1], fields[2]);
+    out.tailLevel = (int) out.levels.size() - 1;
+    for (int i = 0; i < (int) out.levels.size(); i++)
+        if (std::max(out.levels[i].width, out.levels[i].height) <= tailSize) {
+            out.tailLevel = i;
+            break;
+        }
+    const MipLevel &first = out.levels[out.tailLevel];
+    const MipLevel &last = out.levels.back();
+    if (!ReadRange(out.cachePath, first.offset, last.offset + last.bytes - first.offset, out.tail)) {
+        out.levels.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace streaming
+
+struct StreamedTexture {
+    std::string name;
+    std::string cachePath;
+    std::vector<streaming::MipLevel> levels;
+    GlTexture texture;
+    GLenum internalFormat = GL_RGBA8;
+    int tailLevel = 0;
+    int residentLevel = 0;      // najdetaljniji rezidentan nivo (GL_TEXTURE_BASE_LEVEL)
+    int wantedLevel = 0;        // najdetaljniji nivo trazen u ovom frejmu
+    int loadingLevel = -1;      // nivo koji se cita sa diska ili otprema
+    bool failed = false;        // citanje iz kesa nije uspelo: ostaje na rezidentnim nivoima
+    unsigned long long lastUsed = 0;
+    size_t residentBytes = 0;
+
+    size_t FullBytes() const {
+        size_t bytes = 0;
+        for (const streaming::MipLevel &level : levels)
+            bytes += level.bytes;
+        return bytes;
+    }
+};
+
+class TextureStreamer {
+public:
+    // podesavanja; tailSize i cacheDirectory se ne menjaju posle prve teksture (citaju ih radne niti)
+    size_t budgetBytes = 256u * 1024 * 1024;
+    size_t uploadBytesPerFrame = 4u * 1024 * 1024;
+    float lodBias = 0.0f;
+    int tailSize = 64;
+    int maxPendingLoads = 4;
+    std::string cacheDirectory = "resources/";
+
+    // statistika
+    unsigned long long loads = 0;
+    unsigned long long evictions = 0;
+    unsigned long long failedReads = 0;
+    size_t uploadedBytes = 0;       // u poslednjem frejmu
+    bool budgetLimited = false;     // neki trazeni nivo nije stao u budzet
+
+    explicit TextureStreamer(int threadCount = 2) {
+        for (int i = 0; i < threadCount; i++)
+            workers.emplace_back(&TextureStreamer::WorkerLoop, this, i);
+    }
+
+    ~TextureStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    // render nit: tekstura sa repom lanca na GPU; vraca handle (-1 ako izvor nije ucitan)
+    int Register(streaming::TextureSource &&source, bool srgb, bool clampToEdge) {
+        if (!source.Valid())
+            return -1;
+        StreamedTexture texture;
+        texture.name = source.path;
+        texture.cachePath = source.cachePath;
+        texture.levels = source.levels;
+        texture.internalFormat = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        texture.tailLevel = texture.residentLevel = texture.wantedLevel = source.tailLevel;
+        texture.texture = GlTexture::Create(source.path);
+
+        glBindTexture(GL_TEXTURE_2D, texture.texture);
+        size_t offset = 0;
+        for (int i = source.tailLevel; i < (int) source.levels.size(); i++) {
+            const streaming::MipLevel &level = source.levels[i];
+            glTexImage2D(GL_TEXTURE_2D, i, texture.internalFormat, level.width, level.height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, source.tail.data() + offset);
+            offset += level.bytes;
+        }
+        texture.residentBytes = offset;
+        texture.texture.SetBytes(offset);
+        residentBytes += offset;
+
+        GLenum wrap = clampToEdge ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, source.tailLevel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int) source.levels.size() - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        textures.push_back(std::move(texture));
+        return (int) textures.size() - 1;
+    }
+
+    // sinhrono (pri pokretanju): kes, rep i registracija
+    int Load(const std::string &path, bool srgb, bool clampToEdge) {
+        streaming::TextureSource source;
+        streaming::PrepareSource(path, tailSize, cacheDirectory, source);
+        return Register(std::move(source), srgb, clampToEdge);
+    }
+
+    unsigned int TextureId(int handle) const {
+        return handle >= 0 ? textures[handle].texture.Id() : 0;
+    }
+
+    int ResidentLevel(int handle) const {
+        return handle >= 0 ? textures[handle].residentLevel : 0;
+    }
+
+    // projectedPixels: velicina na ekranu povrsine preko koje se tekstura razvlaci jednom
+    void Request(int handle, float projectedPixels) {
+        if (handle < 0)
+            return;
+        StreamedTexture &texture = textures[handle];
+        float size = (float) std::max(texture.levels[0].width, texture.levels[0].height);
+        float level = std::log2(size / std::max(projectedPixels, 1.0f)) + lodBias;
+        int wanted = std::min(std::max((int) std::floor(level), 0), texture.tailLevel);
+        texture.wantedLevel = std::min(texture.wantedLevel, wanted);
+        texture.lastUsed = frame;
+    }
+
+    // jednom po frejmu, posle svih Request poziva
+    void Update() {
+        TraceZone zone("Texture streaming", "streaming");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (Result &result : results)
+                uploads.push_back(std::move(result));
+            results.clear();
+        }
+
+        // otpremanje ucitanih nivoa po redovima u okviru budzeta
+        uploadedBytes = 0;
+        while (!uploads.empty() && uploadedBytes < uploadBytesPerFrame) {
+            if (UploadRows(uploads.front()))
+                uploads.pop_front();
+        }
+
+        // novi nivoi: prvo najveca razlika izmedju trazenog i rezidentnog, pa skorije trazene
+        budgetLimited = false;
+        int pending = PendingLoads();
+        if (pending < maxPendingLoads) {
+            candidates.clear();
+            for (int i = 0; i < (int) textures.size(); i++)
+                if (textures[i].loadingLevel < 0 && !textures[i].failed && textures[i].wantedLevel < textures[i].residentLevel)
+                    candidates.push_back(i);
+            std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+                int gapA = textures[a].residentLevel - textures[a].wantedLevel;
+                int gapB = textures[b].residentLevel - textures[b].wantedLevel;
+                return gapA != gapB ? gapA > gapB : textures[a].lastUsed > textures[b].lastUsed;
+            });
+            for (int handle : candidates) {
+                if (pending >= maxPendingLoads)
+                    break;
+                StreamedTexture &texture = textures[handle];
+                int level = texture.residentLevel - 1;
+                if (!MakeRoom(texture.levels[level].bytes)) {
+                    budgetLimited = true;
+                    break;
+                }
+                texture.loadingLevel = level;
+                residentBytes += texture.levels[level].bytes;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    jobs.push_back({handle, level, texture.cachePath, texture.levels[level].offset,
+                                    texture.levels[level].bytes});
+                }
+                condition.notify_one();
+                pending++;
+            }
+        }
+
+        for (StreamedTexture &texture : textures)
+            texture.wantedLevel = texture.tailLevel;
+        TraceCounter("Streamed texture MB", residentBytes / (1024.0 * 1024.0));
+        frame++;
+    }
+
+    // ucitavanje ili otpremanje u toku
+    bool Busy() const {
+        return PendingLoads() > 0;
+    }
+
+    size_t ResidentBytes() const {
+        return residentBytes;
+    }
+
+    size_t FullBytes() const {
+        size_t bytes = 0;
+        for (const StreamedTexture &texture : textures)
+            bytes += texture.FullBytes();
+        return bytes;
+    }
+
+    const std::vector<StreamedTexture> &Textures() const {
+        return textures;
+    }
+
+private:
+    struct Job {
+        int handle;
+        int level;
+        std::string cachePath;
+        size_t offset;
+        size_t bytes;
+    };
+
+    struct Result {
+        int handle = -1;
+        int level = 0;
+        std::vector<unsigned char> pixels;
+        int nextRow = 0;
+    };
+
+    std::vector<StreamedTexture> textures;
+    std::vector<int> candidates;
+    std::deque<Result> uploads;
+    size_t residentBytes = 0;       // rezidentni nivoi + nivoi koji se ucitavaju
+    unsigned long long frame = 1;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+    bool stopping = false;
+
+    int PendingLoads() const {
+        int pending = 0;
+        for (const StreamedTexture &texture : textures)
+            if (texture.loadingLevel >= 0)
+                pending++;
+        return pending;
+    }
+
+    // LRU: izbacuje se najdetaljniji nivo teksture koja najduze nije trazena, osim nivoa potrebnih sada
+    bool MakeRoom(size_t bytes) {
+        while (residentBytes + bytes > budgetBytes) {
+            int victim = -1;
+            for (int i = 0; i < (int) textures.size(); i++) {
+                const StreamedTexture &texture = textures[i];
+                if (texture.residentLevel >= texture.tailLevel || texture.loadingLevel >= 0)
+                    continue;
+                if (texture.lastUsed == frame && texture.residentLevel >= texture.wantedLevel)
+                    continue;
+                if (victim < 0 || texture.lastUsed < textures[victim].lastUsed)
+                    victim = i;
+            }
+            if (victim < 0)
+                return false;
+            Evict(textures[victim]);
+        }
+        return true;
+    }
+
+    void Evict(StreamedTexture &texture) {
+        const streaming::MipLevel &level = texture.levels[texture.residentLevel];
+        glBindTexture(GL_TEXTURE_2D, texture.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.residentLevel + 1);
+        glTexImage2D(GL_TEXTURE_2D, texture.residentLevel, texture.internalFormat, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        texture.residentLevel++;
+        texture.residentBytes -= level.bytes;
+        texture.texture.SetBytes(texture.residentBytes);
+        residentBytes -= level.bytes;
+        evictions++;
+    }
+
+    // deo redova nivoa; kad je nivo ceo, postaje osnovni nivo teksture. Vraca true kada je gotovo
+    bool UploadRows(Result &result) {
+        StreamedTexture &texture = textures[result.handle];
+        const streaming::MipLevel &level = texture.levels[result.level];
+        if (result.pixels.size() != level.bytes) {
+            // citanje nije uspelo (kes obrisan ili ostecen): nivo se ne otprema, rezervacija se vraca, a tekstura
+            // se vise ne strimuje (inace bi se isti nivo trazio svaki frejm); kes se brise, pa ga sledece
+            // pokretanje pravi ponovo iz slike
+            residentBytes -= level.bytes;
+            texture.loadingLevel = -1;
+            texture.failed = true;
+            failedReads++;
+            std::cout << "Texture streaming failed to read " << texture.cachePath << ", cache removed" << std::endl;
+            std::remove(texture.cachePath.c_str());
+            return true;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, texture.texture);
+        if (result.nextRow == 0)
+            glTexImage2D(GL_TEXTURE_2D, result.level, texture.internalFormat, level.width, level.height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, NULL);
+        size_t rowBytes = (size_t) level.width * 4;
+        int rows = (int) std::max<size_t>(1, (uploadBytesPerFrame - std::min(uploadedBytes, uploadBytesPerFrame)) / rowBytes);
+        rows = std::min(rows, level.height - result.nextRow);
+        glTexSubImage2D(GL_TEXTURE_2D, result.level, 0, result.nextRow, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+                        result.pixels.data() + result.nextRow * rowBytes);
+        result.nextRow += rows;
+        uploadedBytes += rows * rowBytes;
+        if (result.nextRow < level.height)
+            return false;
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, result.level);
+        texture.residentLevel = result.level;
+        texture.loadingLevel = -1;
+        texture.residentBytes += level.bytes;
+        texture.texture.SetBytes(texture.residentBytes);
+        loads++;
+        return true;
+    }
+
+    void WorkerLoop(int index) {
+        Tracer::Get().SetThreadName("texture streaming " + std::to_string(index));
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping)
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            TraceZone zone("Read mip level", "streaming");
+            Result result;
+            result.handle = job.handle;
+            result.level = job.level;
+            if (!streaming::ReadRange(job.cachePath, job.offset, job.bytes, result.pixels))
+                result.pixels.clear();
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(result));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,466 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <glad/glad.h>
+
+#include <gl_resources.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Snimanje vremenske linije u Chrome Trace Event JSON (otvara se u chrome://tracing ili
+// ui.perfetto.dev), da bi se zastoji frejmova mogli analizirati iz fajla koji korisnik posalje.
+//
+// Svaka nit pise dogadjaje u svoj prsten (jedan pisac, jedan citalac, bez zakljucavanja);
+// pozadinska nit ih periodicno prazni i formatira u fajl, pa na render niti ostaje samo
+// upis u prsten. Kada je prsten pun dogadjaj se odbacuje (i broji), nikad se ne ceka.
+// GPU zone su GL_TIMESTAMP upiti prevedeni na isti sat kao i CPU dogadjaji.
+
+enum class TraceEventType : unsigned char {
+    Zone,
+    Counter
+};
+
+struct TraceEvent {
+    const char *name;       // staticki string ili Tracer::Intern
+    const char *category;
+    long long start;        // ns od pocetka procesa
+    long long duration;
+    double value;
+    int track;              // -1: nit koja je upisala dogadjaj
+    TraceEventType type;
+};
+
+class TraceThreadBuffer {
+public:
+    static const unsigned int capacity = 1 << 14;
+
+    int threadId;
+    std::string threadName;
+    bool nameWritten = false;
+    std::atomic<unsigned int> dropped;
+
+    explicit TraceThreadBuffer(int threadId)
+            : threadId(threadId), dropped(0), events(capacity), head(0), tail(0) {}
+
+    // samo nit vlasnik
+    void Push(const TraceEvent &event) {
+        unsigned int h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[h % capacity] = event;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // samo nit koja prazni bafere
+    template<typename Function>
+    void Drain(Function function) {
+        unsigned int t = tail.load(std::memory_order_relaxed);
+        unsigned int h = head.load(std::memory_order_acquire);
+        for (; t != h; t++)
+            function(events[t % capacity]);
+        tail.store(t, std::memory_order_release);
+    }
+
+private:
+    std::vector<TraceEvent> events;
+    std::atomic<unsigned int> head;
+    std::atomic<unsigned int> tail;
+};
+
+class Tracer {
+public:
+    static Tracer &Get() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    ~Tracer() {
+        Stop();
+    }
+
+    static long long Now() {
+        static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    bool Enabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // frames > 0: snimanje se samo zaustavlja posle toliko frejmova (FrameMark)
+    bool Start(const std::string &path, int frames = 0) {
+        if (Enabled())
+            return false;
+        std::lock_guard<std::mutex> lock(fileMutex);
+        file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            std::printf("Trace file could not be opened: %s\n", path.c_str());
+            return false;
+        }
+        filePath = path;
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+        firstEvent = true;
+        eventsWritten = 0;
+
+        // dogadjaji zaostali od prethodnog snimanja se odbacuju
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        for (auto &buffer : buffers) {
+            buffer->Drain([](const TraceEvent &) {});
+            buffer->nameWritten = false;
+            buffer->dropped = 0;
+        }
+        for (Track &track : tracks)
+            track.nameWritten = false;
+
+        framesLeft = frames;
+        running = true;
+        enabled = true;
+        flusher = std::thread(&Tracer::FlushLoop, this);
+        return true;
+    }
+
+    void Stop() {
+        if (!enabled.exchange(false))
+            return;
+        {
+            std::lock_guard<std::mutex> lock(flushMutex);
+            running = false;
+        }
+        flushCondition.notify_all();
+        flusher.join();
+
+        std::lock_guard<std::mutex> lock(fileMutex);
+        Flush();
+        std::fputs("\n]}\n", file);
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    // render nit, jednom po frejmu: odbrojavanje snimanja zadatog broja frejmova
+    void FrameMark() {
+        if (!Enabled() || framesLeft <= 0)
+            return;
+        if (--framesLeft == 0)
+            Stop();
+    }
+
+    void Push(const TraceEvent &event) {
+        ThreadBuffer().Push(event);
+    }
+
+    void SetThreadName(const std::string &name) {
+        TraceThreadBuffer &buffer = ThreadBuffer();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer.threadName = name;
+        buffer.nameWritten = false;
+    }
+
+    // dodatni red na vremenskoj liniji koji ne pripada niti (npr. GPU)
+    int RegisterTrack(const std::string &name) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        tracks.push_back({nextThreadId, name, false});
+        return nextThreadId++;
+    }
+
+    // trajna kopija imena koje nije staticki string (putanje fajlova)
+    const char *Intern(const std::string &text) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::string &existing : interned)
+            if (existing == text)
+                return existing.c_str();
+        interned.push_back(text);
+        return interned.back().c_str();
+    }
+
+    const std::string &Path() const { return filePath; }
+    unsigned long long EventsWritten() const { return eventsWritten; }
+    int FramesLeft() const { return framesLeft; }
+
+    unsigned int Dropped() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        unsigned int dropped = 0;
+        for (auto &buffer : buffers)
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        return dropped;
+    }
+
+private:
+    struct Track {
+        int threadId;
+        std::string name;
+        bool nameWritten;
+    };
+
+    std::atomic<bool> enabled{false};
+    int framesLeft = 0;
+
+    // baferi zive do kraja programa, pa nit moze da se zavrsi bez odjave
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<TraceThreadBuffer>> buffers;
+    std::vector<Track> tracks;
+    std::deque<std::string> interned;
+    int nextThreadId = 1;
+
+    std::mutex fileMutex;
+    std::FILE *file = nullptr;
+    std::string filePath;
+    bool firstEvent = true;
+    std::atomic<unsigned long long> eventsWritten{0};
+
+    std::thread flusher;
+    std::mutex flushMutex;
+    std::condition_variable flushCondition;
+    bool running = false;
+
+    Tracer() = default;
+
+    TraceThreadBuffer &ThreadBuffer() {
+        thread_local TraceThreadBuffer *buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers.emplace_back(new TraceThreadBuffer(nextThreadId++));
+            buffer = buffers.back().get();
+        }
+        return *buffer;
+    }
+
+    void FlushLoop() {
+        std::unique_lock<std::mutex> lock(flushMutex);
+        while (running) {
+            flushCondition.wait_for(lock, std::chrono::milliseconds(50));
+            std::lock_guard<std::mutex> fileLock(fileMutex);
+            Flush();
+        }
+    }
+
+    // poziva se pod fileMutex
+    void Flush() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (Track &track : tracks)
+            if (!track.nameWritten) {
+                WriteThreadName(track.threadId, track.name);
+                track.nameWritten = true;
+            }
+        for (auto &buffer : buffers) {
+            if (!buffer->nameWritten && !buffer->threadName.empty()) {
+                WriteThreadName(buffer->threadId, buffer->threadName);
+                buffer->nameWritten = true;
+            }
+            int threadId = buffer->threadId;
+            buffer->Drain([this, threadId](const TraceEvent &event) {
+                WriteEvent(event, event.track >= 0 ? event.track : threadId);
+            });
+        }
+        std::fflush(file);
+    }
+
+    void BeginRecord() {
+        if (!firstEvent)
+            std::fputs(",\n", file);
+        firstEvent = false;
+        eventsWritten++;
+    }
+
+    void WriteThreadName(int threadId, const std::string &name) {
+        BeginRecord();
+        std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", threadId);
+        WriteEscaped(name.c_str());
+        std::fputs("\"}}", file);
+    }
+
+    void WriteEvent(const TraceEvent &event, int threadId) {
+        BeginRecord();
+        std::fputs("{\"name\":\"", file);
+        WriteEscaped(event.name);
+        std::fprintf(file, "\",\"cat\":\"%s\",", event.category);
+        if (event.type == TraceEventType::Zone)
+            std::fprintf(file, "\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                         event.start / 1000.0, event.duration / 1000.0, threadId);
+        else
+            std::fprintf(file, "\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%g}}",
+                         event.start / 1000.0, threadId, event.value);
+    }
+
+    void WriteEscaped(const char *text) {
+        for (; *text; text++) {
+            if (*text == '"' || *text == '\\')
+                std::fputc('\\', file);
+            if ((unsigned char) *text >= 0x20)
+                std::fputc(*text, file);
+        }
+    }
+};
+
+// CPU zona od konstrukcije do End() ili kraja opsega
+class TraceZone {
+public:
+    explicit TraceZone(const char *name, const char *category = "cpu")
+            : name(name), category(category), start(Tracer::Get().Enabled() ? Tracer::Now() : -1) {}
+
+    ~TraceZone() {
+        End();
+    }
+
+    void End() {
+        if (start < 0)
+            return;
+        if (Tracer::Get().Enabled())
+            Tracer::Get().Push({name, category, start, Tracer::Now() - start, 0.0, -1, TraceEventType::Zone});
+        start = -1;
+    }
+
+private:
+    const char *name;
+    const char *category;
+    long long start;
+};
+
+inline void TraceCounter(const char *name, double value) {
+    if (Tracer::Get().Enabled())
+        Tracer::Get().Push({name, "counter", Tracer::Now(), 0, value, -1, TraceEventType::Counter});
+}
+
+// GPU zone: par GL_TIMESTAMP upita po zoni, rezultati se citaju frameLatency frejmova kasnije
+// bez cekanja. Pomeraj GPU sata prema CPU satu se meri svaki frejm (glGetInteger64v).
+class GpuTraceZones {
+public:
+    static const int frameLatency = 3;
+    static const int maxZones = 32;
+    static const int maxDepth = 8;
+
+    // pocetak frejma na render niti: citanje najstarijeg frejma i priprema njegovih upita
+    void BeginFrame() {
+        active = Tracer::Get().Enabled();
+        if (!active) {
+            for (Frame &frame : frames)
+                frame.count = 0;
+            depth = 0;
+            return;
+        }
+        if (frames[0].queries.empty()) {
+            track = Tracer::Get().RegisterTrack("GPU");
+            for (int f = 0; f < frameLatency; f++)
+                for (int i = 0; i < maxZones * 2; i++)
+                    frames[f].queries.push_back(GlQuery::Create("GPU trace " + std::to_string(f) + "/" + std::to_string(i)));
+        }
+
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        offset = Tracer::Now() - (long long) gpuNow;
+
+        current = (current + 1) % frameLatency;
+        Frame &frame = frames[current];
+        if (frame.count > 0) {
+            GLint available = 0;
+            glGetQueryObjectiv(frame.queries[frame.lastQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                for (int i = 0; i < frame.count; i++) {
+                    GLuint64 begin = 0, end = 0;
+                    glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+                    glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+                    Tracer::Get().Push({frame.names[i], "gpu", (long long) begin + frame.offset,
+                                        (long long) (end - begin), 0.0, track, TraceEventType::Zone});
+                }
+            }
+        }
+        frame.count = 0;
+        frame.offset = offset;
+        depth = 0;
+        skipped = 0;
+    }
+
+    // zone preko ogranicenja (broj ili dubina) se preskacu
+    void Begin(const char *name) {
+        if (!active)
+            return;
+        Frame &frame = frames[current];
+        if (skipped > 0 || depth == maxDepth || frame.count == maxZones) {
+            skipped++;
+            return;
+        }
+        int zone = frame.count++;
+        frame.names[zone] = name;
+        glQueryCounter(frame.queries[zone * 2], GL_TIMESTAMP);
+        open[depth++] = zone;
+    }
+
+    void End() {
+        if (!active)
+            return;
+        if (skipped > 0) {
+            skipped--;
+            return;
+        }
+        if (depth == 0)
+            return;
+        Frame &frame = frames[current];
+        frame.lastQuery = open[--depth] * 2 + 1;
+        glQueryCounter(frame.queries[frame.lastQuery], GL_TIMESTAMP);
+    }
+
+private:
+    struct Frame {
+        std::vector<GlQuery> queries;
+        const char *names[maxZones];
+        int count = 0;
+        int lastQuery = 0;      // poslednji poslat upit; kada je on gotov, gotovi su i svi pre njega
+        long long offset = 0;
+    };
+
+    Frame frames[frameLatency];
+    int current = 0;
+    int open[maxDepth];
+    int depth = 0;
+    int skipped = 0;
+    int track = -1;
+    long long offset = 0;
+    bool active = false;
+};
+
+// prolaz renderovanja: ista zona na CPU i GPU redu vremenske linije
+class TracePass {
+public:
+    TracePass(GpuTraceZones &gpu, const char *name)
+            : zone(name, "render"), gpu(gpu) {
+        gpu.Begin(name);
+    }
+
+    ~TracePass() {
+        End();
+    }
+
+    void End() {
+        if (ended)
+            return;
+        gpu.End();
+        zone.End();
+        ended = true;
+    }
+
+private:
+    TraceZone zone;
+    GpuTraceZones &gpu;
+    bool ended = false;
+};
+
+// ime fajla sa vremenom pocetka snimanja (trace_20240101_120000.json)
+inline std::string TimestampedTracePath() {
+    std::time_t now = std::time(nullptr);
+    char name[64];
+    std::strftime(name, sizeof(name), "trace_%Y%m%d_%H%M%S.json", std::localtime(&now));
+    return name;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef UNIFORMS_H
+#define UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/shader.h>
+
+// Postavljanje uniform promenljivih sa imenom kao const char*. Shader::set* prima
+// const std::string&, pa svaki poziv sa literalom duzim od 15 znakova pravi string na hipu;
+// ove funkcije se koriste u petlji za renderovanje umesto njih.
+
+inline void SetInt(const Shader &shader, const char *name, int value) {
+    glUniform1i(glGetUniformLocation(shader.ID, name), value);
+}
+
+inline void SetFloat(const Shader &shader, const char *name, float value) {
+    glUniform1f(glGetUniformLocation(shader.ID, name), value);
+}
+
+inline void SetVec3(const Shader &shader, const char *name, const glm::vec3 &value) {
+    glUniform3fv(glGetUniformLocation(shader.ID, name), 1, &value[0]);
+}
+
+inline void SetVec3(const Shader &shader, const char *name, float x, float y, float z) {
+    glUniform3f(glGetUniformLocation(shader.ID, name), x, y, z);
+}
+
+inline void SetMat4(const Shader &shader, const char *name, const glm::mat4 &value) {
+    glUniformMatrix4fv(glGetUniformLocation(shader.ID, name), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+#endif
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    // isti izraz kao u shaderima scene; to ne garantuje istu dubinu u razlicitim programima,
+    // pa se pre-pass crta sa polygon offset-om, a glavni prolaz sa GL_LEQUAL
+    vec3 FragPos = vec3(model * vec4(aPos, 1.0));
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) out float MaxDepth;
+
+// prethodni nivo piramide (ili kopija dubine za prvi nivo); vezan je samo taj nivo
+uniform sampler2D source;
+uniform ivec2 sourceSize;
+
+void main()
+{
+    // max 2x2 teksela; kod neparne velicine izvora uzima se i treci red/kolona
+    ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+    ivec2 last = sourceSize - 1;
+    int extraX = (sourceSize.x & 1) != 0 && base.x + 2 == last.x ? 2 : 1;
+    int extraY = (sourceSize.y & 1) != 0 && base.y + 2 == last.y ? 2 : 1;
+
+    float depth = 0.0;
+    for (int y = 0; y <= extraY; y++)
+        for (int x = 0; x <= extraX; x++)
+            depth = max(depth, texelFetch(source, min(base + ivec2(x, y), last), 0).r);
+    MaxDepth = depth;
+}
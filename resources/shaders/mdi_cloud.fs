@@ -0,0 +1,22 @@
+#version 430 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+in vec2 TexCoords;
+flat in uint Layer;
+
+uniform sampler2DArray diffuseTextures;
+
+void main()
+{
+    // stranice nizova su GL_REPEAT; UV se drzi pola teksela od ivice umesto GL_CLAMP_TO_EDGE
+    vec2 halfTexel = 0.5 / vec2(textureSize(diffuseTextures, 0).xy);
+    vec2 uv = clamp(TexCoords, halfTexel, 1.0 - halfTexel);
+    vec4 color = texture(diffuseTextures, vec3(uv, float(Layer)));
+    if (color.a < 0.1)
+        discard;
+
+    // oblaci ne sijaju: u bloom baferu samo prekrivaju ono iza sebe
+    FragColor = color;
+    BrightColor = vec4(0.0, 0.0, 0.0, color.a);
+}
@@ -0,0 +1,29 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in uint aDrawId;
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+    vec4 sphere;
+    uvec4 material;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+out vec2 TexCoords;
+flat out uint Layer;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    DrawData draw = draws[aDrawId];
+    TexCoords = aTexCoords;
+    Layer = draw.material.y;
+    gl_Position = projection * view * draw.model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,50 @@
+#version 430 core
+layout (local_size_x = 64) in;
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+    vec4 sphere;
+    uvec4 material;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+layout (std430, binding = 1) buffer Commands {
+    DrawCommand commands[];
+};
+
+layout (std430, binding = 2) buffer Counter {
+    uint culled;
+};
+
+uniform vec4 planes[6];
+uniform uint drawCount;
+
+void main()
+{
+    // odsecanje po frustumu: nevidljiva komanda ostaje, ali sa instanceCount = 0
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= drawCount)
+        return;
+
+    vec4 sphere = draws[commands[id].baseInstance].sphere;
+    bool visible = true;
+    for (int i = 0; i < 6; i++)
+        if (dot(planes[i].xyz, sphere.xyz) + planes[i].w < -sphere.w)
+            visible = false;
+
+    commands[id].instanceCount = visible ? 1u : 0u;
+    if (!visible)
+        atomicAdd(culled, 1u);
+}
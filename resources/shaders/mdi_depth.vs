@@ -0,0 +1,26 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in uint aDrawId;
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+    vec4 sphere;
+    uvec4 material;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+invariant gl_Position;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    // isti izraz kao u mdi_lit.vs (oba su invariant), da bi dubina bila identicna
+    vec3 FragPos = vec3(draws[aDrawId].model * vec4(aPos, 1.0));
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
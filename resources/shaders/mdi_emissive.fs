@@ -0,0 +1,12 @@
+#version 430 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+flat in vec4 Color;
+
+void main()
+{
+    // svetlece kocke: boja iz podataka crtanja, cela ide i u bloom
+    FragColor = Color;
+    BrightColor = Color;
+}
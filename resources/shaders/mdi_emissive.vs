@@ -0,0 +1,26 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in uint aDrawId;
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+    vec4 sphere;
+    uvec4 material;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+flat out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    DrawData draw = draws[aDrawId];
+    Color = draw.color;
+    gl_Position = projection * view * draw.model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,174 @@
+#version 430 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+struct PointLight {
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct DirLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+flat in vec4 Color;
+flat in uvec2 Layers;
+flat in float Shininess;
+flat in uint LightSet;
+
+// stranice nizova tekstura grupe crtanja; sloj materijala dolazi iz podataka crtanja
+uniform sampler2DArray diffuseTextures;
+uniform sampler2DArray specularTextures;
+
+// skupovi svetala: svaki objekat je u pojedinacnim shaderima imao svoja usmerena i tackasta
+// svetla, materijal bira skup (dva tackasta svetla po skupu)
+const int lightSetCount = 3;
+uniform PointLight pointLight[2 * lightSetCount];
+uniform DirLight dirLight[lightSetCount];
+uniform SpotLight spotLight;
+
+// sjaj materijala, postavlja se na pocetku main()
+float shininess;
+uniform vec3 viewPosition;
+
+// osvetljenje iz okoline (ibl.h): SH9 iradijansa / pi i GGX prefiltrirana cubemapa;
+// kada je ukljuceno zamenjuje konstantnu ambijentalnu boju usmerenog svetla
+uniform bool iblEnabled;
+uniform vec3 shCoefficients[9];
+uniform samplerCube prefilterMap;
+uniform float prefilterMaxLod;
+uniform float prefilterIntensity;
+
+vec3 ShIrradiance(vec3 n)
+{
+    return shCoefficients[0] * 0.282095
+         + shCoefficients[1] * 0.488603 * n.y
+         + shCoefficients[2] * 0.488603 * n.z
+         + shCoefficients[3] * 0.488603 * n.x
+         + shCoefficients[4] * 1.092548 * n.x * n.y
+         + shCoefficients[5] * 1.092548 * n.y * n.z
+         + shCoefficients[6] * 0.315392 * (3.0 * n.z * n.z - 1.0)
+         + shCoefficients[7] * 1.092548 * n.x * n.z
+         + shCoefficients[8] * 0.546274 * (n.x * n.x - n.y * n.y);
+}
+
+// analiticka aproksimacija BRDF integrala (umesto LUT teksture)
+vec3 EnvBrdfApprox(vec3 specularColor, float roughness, float NdotV)
+{
+    const vec4 c0 = vec4(-1.0, -0.0275, -0.572, 0.022);
+    const vec4 c1 = vec4(1.0, 0.0425, 1.04, -0.04);
+    vec4 r = roughness * c0 + c1;
+    float a004 = min(r.x * r.x, exp2(-9.28 * NdotV)) * r.x + r.y;
+    vec2 AB = vec2(-1.04, 1.04) * a004 + r.zw;
+    return specularColor * AB.x + AB.y;
+}
+
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    vec3 ambient = light.ambient * diffuseColor;
+    vec3 diffuse = light.diffuse * diff * diffuseColor;
+    vec3 specular = light.specular * spec * specularColor;
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec3 lightDir = normalize(-light.direction);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    vec3 ambient = light.ambient * diffuseColor;
+    vec3 diffuse = light.diffuse * diff * diffuseColor;
+    vec3 specular = light.specular * spec * specularColor;
+    return ambient + diffuse + specular;
+}
+
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    vec3 ambient = light.ambient * diffuseColor;
+    vec3 diffuse = light.diffuse * diff * diffuseColor;
+    vec3 specular = light.specular * spec * specularColor;
+    return (ambient + diffuse + specular) * attenuation * intensity;
+}
+
+void main()
+{
+    shininess = Shininess;
+    int lightSet = int(LightSet);
+    vec3 normal = normalize(Normal);
+    vec3 viewDir = normalize(viewPosition - FragPos);
+    // bez teksture: bela difuzna boja i bez spekularnog odsjaja
+    vec3 diffuseColor = Color.rgb;
+    if (Layers.x != 0xFFFFFFFFu)
+        diffuseColor *= texture(diffuseTextures, vec3(TexCoords, float(Layers.x))).rgb;
+    vec3 specularColor = vec3(0.0);
+    if (Layers.y != 0xFFFFFFFFu)
+        specularColor = texture(specularTextures, vec3(TexCoords, float(Layers.y))).rrr;
+
+    vec3 result;
+    if (iblEnabled) {
+        DirLight light = dirLight[lightSet];
+        light.ambient = vec3(0.0);
+        result = CalcDirLight(light, normal, viewDir, diffuseColor, specularColor);
+
+        // hrapavost iz Blinn-Phong sjaja
+        float roughness = sqrt(2.0 / (shininess + 2.0));
+        vec3 reflected = reflect(-viewDir, normal);
+        vec3 prefiltered = textureLod(prefilterMap, reflected, roughness * prefilterMaxLod).rgb * prefilterIntensity;
+        result += diffuseColor * max(ShIrradiance(normal), vec3(0.0))
+                + prefiltered * EnvBrdfApprox(specularColor, roughness, max(dot(normal, viewDir), 0.0));
+    } else {
+        result = CalcDirLight(dirLight[lightSet], normal, viewDir, diffuseColor, specularColor);
+    }
+    for (int i = 0; i < 2; i++)
+        result += CalcPointLight(pointLight[2 * lightSet + i], normal, FragPos, viewDir, diffuseColor, specularColor);
+    result += CalcSpotLight(spotLight, normal, FragPos, viewDir, diffuseColor, specularColor);
+
+    FragColor = vec4(result, 1.0);
+    float brightness = dot(FragColor.rgb, vec3(0.2126, 0.7152, 0.0722));
+    BrightColor = brightness > 1.0 ? vec4(FragColor.rgb, 1.0) : vec4(0.0, 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,55 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in uint aDrawId;
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+    vec4 sphere;
+    uvec4 material;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+struct MaterialData {
+    float shininess;
+    uint lightSet;
+    uint padding0;
+    uint padding1;
+};
+
+layout (std430, binding = 3) readonly buffer Materials {
+    MaterialData materials[];
+};
+
+out vec2 TexCoords;
+out vec3 Normal;
+out vec3 FragPos;
+flat out vec4 Color;
+flat out uvec2 Layers;
+flat out float Shininess;
+flat out uint LightSet;
+
+invariant gl_Position;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    // drawId = baseInstance komande (instanced atribut), indeks u listu crtanja
+    DrawData draw = draws[aDrawId];
+    FragPos = vec3(draw.model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(draw.model))) * aNormal;
+    TexCoords = aTexCoords;
+    Color = draw.color;
+    Layers = draw.material.yz;
+    MaterialData material = materials[draw.material.x];
+    Shininess = material.shininess;
+    LightSet = material.lightSet;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+in vec2 Corner;
+in vec4 Color;
+
+uniform float intensity;
+
+void main()
+{
+    // meka okrugla iskra; aditivno mesanje, cela boja ide i u bloom
+    float falloff = 1.0 - dot(Corner, Corner);
+    if (falloff <= 0.0)
+        discard;
+    vec3 color = Color.rgb * Color.a * falloff * falloff * intensity;
+    FragColor = vec4(color, 0.0);
+    BrightColor = vec4(color, 0.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec4 aPositionSize;
+layout (location = 1) in vec4 aColor;
+
+out vec2 Corner;
+out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    // temena trake iz gl_VertexID; kvadrat se siri u prostoru pogleda, pa je uvek okrenut ka kameri
+    Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    Color = aColor;
+    vec4 viewPosition = view * vec4(aPositionSize.xyz, 1.0);
+    viewPosition.xy += Corner * aPositionSize.w;
+    gl_Position = projection * viewPosition;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+uniform float progress;
+
+void main()
+{
+    // bounding box modela koji se jos ucitava: boja prelazi iz sive u zelenu kako napreduje
+    FragColor = vec4(mix(vec3(0.6), vec3(0.2, 1.0, 0.3), progress), 1.0);
+    BrightColor = vec4(0.0, 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,50 @@
+#version 330 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+// mnozi se sa bojom u hdrFBO (glBlendFunc(GL_ZERO, GL_SRC_COLOR))
+uniform sampler2D sceneDepth;
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 inverseViewProjection;
+uniform mat4 lightViewProjection[3];
+uniform float cascadeFar[3];
+uniform float texelWorld[3];
+uniform vec3 cameraPosition;
+uniform vec2 renderSize;
+uniform float strength;
+
+void main()
+{
+    float depth = texelFetch(sceneDepth, ivec2(gl_FragCoord.xy), 0).r;
+    vec4 clip = vec4(gl_FragCoord.xy / renderSize * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * clip;
+    vec3 position = world.xyz / world.w;
+
+    // normala iz izvoda polozaja (pre discard-a), okrenuta ka kameri
+    vec3 normal = normalize(cross(dFdx(position), dFdy(position)));
+    if (dot(normal, cameraPosition - position) < 0.0)
+        normal = -normal;
+
+    // skybox i sve van poslednje kaskade ostaje neosenceno
+    float distance = length(position - cameraPosition);
+    if (depth >= 1.0 || distance > cascadeFar[2])
+        discard;
+    int cascade = distance > cascadeFar[0] ? (distance > cascadeFar[1] ? 2 : 1) : 0;
+
+    // pomeraj po normali (u tekselima kaskade) protiv akni na povrsinama pod uglom
+    vec4 light = lightViewProjection[cascade] * vec4(position + normal * texelWorld[cascade] * 1.5, 1.0);
+    vec3 coords = light.xyz / light.w * 0.5 + 0.5;
+
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float visibility = 0.0;
+    for (int y = -1; y <= 1; y++)
+        for (int x = -1; x <= 1; x++)
+            visibility += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), coords.z));
+    visibility /= 9.0;
+
+    // senka blago nestaje pred kraj poslednje kaskade
+    float fade = clamp((cascadeFar[2] - distance) / (0.1 * cascadeFar[2]), 0.0, 1.0);
+    float factor = 1.0 - strength * (1.0 - visibility) * fade;
+    FragColor = vec4(vec3(factor), 1.0);
+    BrightColor = vec4(vec3(factor), 1.0);
+}
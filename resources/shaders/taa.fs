@@ -0,0 +1,74 @@
+#version 330 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+in vec2 TexCoords;
+
+// hdr boja, svetla boja i dubina u internoj rezoluciji (donji levi deo teksture)
+uniform sampler2D scene;
+uniform sampler2D bright;
+uniform sampler2D depth;
+// rezultat prethodnog frejma u punoj rezoluciji
+uniform sampler2D history;
+
+uniform vec2 renderScale;
+uniform vec2 texelSize;
+uniform vec2 jitter;
+uniform mat4 inverseViewProjection;
+uniform mat4 previousViewProjection;
+uniform bool historyValid;
+uniform float feedback;
+
+vec3 ToYCoCg(vec3 c)
+{
+    return vec3(0.25 * c.r + 0.5 * c.g + 0.25 * c.b, 0.5 * c.r - 0.5 * c.b, -0.25 * c.r + 0.5 * c.g - 0.25 * c.b);
+}
+
+vec3 FromYCoCg(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+float Luma(vec3 c)
+{
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+void main()
+{
+    // piksel izlaza u internoj rezoluciji, bez pomeraja (jitter) ovog frejma
+    vec2 maxUV = renderScale - 0.5 * texelSize;
+    vec2 uv = min(TexCoords * renderScale - jitter, maxUV);
+    vec3 current = texture(scene, uv).rgb;
+
+    // opseg boja 3x3 okoline, na koji se ogranicava istorija
+    vec3 minColor = vec3(1e9);
+    vec3 maxColor = vec3(-1e9);
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec3 c = ToYCoCg(texture(scene, clamp(uv + vec2(x, y) * texelSize, vec2(0.0), maxUV)).rgb);
+            minColor = min(minColor, c);
+            maxColor = max(maxColor, c);
+        }
+    }
+
+    // vektor kretanja: tacka iz dubine se vraca u svet i projektuje matricom prethodnog frejma
+    float d = texture(depth, uv).r;
+    vec4 world = inverseViewProjection * vec4(TexCoords * 2.0 - 1.0, d * 2.0 - 1.0, 1.0);
+    world /= world.w;
+    vec4 previous = previousViewProjection * world;
+    vec2 previousUV = previous.xy / previous.w * 0.5 + 0.5;
+    bool offscreen = any(lessThan(previousUV, vec2(0.0))) || any(greaterThan(previousUV, vec2(1.0)));
+
+    vec3 result = current;
+    if (historyValid && !offscreen) {
+        vec3 past = FromYCoCg(clamp(ToYCoCg(texture(history, previousUV).rgb), minColor, maxColor));
+        // tezine po osvetljenosti smanjuju treperenje jako svetlih HDR piksela
+        float currentWeight = (1.0 - feedback) / (1.0 + Luma(current));
+        float pastWeight = feedback / (1.0 + Luma(past));
+        result = (current * currentWeight + past * pastWeight) / (currentWeight + pastWeight);
+    }
+
+    FragColor = vec4(result, 1.0);
+    BrightColor = vec4(texture(bright, uv).rgb, 1.0);
+}
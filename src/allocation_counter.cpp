@@ -0,0 +1,57 @@
+#include <frame_arena.h>
+
+#include <cstdlib>
+#include <new>
+
+// Zamena globalnih operator new/delete koja samo broji alokacije na hipu,
+// da bi se u ImGui-u videlo koliko alokacija ostaje po frejmu.
+// Brojac je po niti: alokacije radnih niti (import modela, cestice, upis slika) se ne mesaju
+// sa alokacijama render niti. Trivijalan tip, pa nema dinamicke inicijalizacije unutar operator new.
+
+static thread_local unsigned long long heapAllocations = 0;
+
+unsigned long long HeapAllocationCount() {
+    return heapAllocations;
+}
+
+static void *CountedAllocate(std::size_t size) {
+    heapAllocations++;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size) {
+    return CountedAllocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return CountedAllocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    heapAllocations++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    heapAllocations++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -14,7 +14,29 @@
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
 
+#include <culling.h>
+#include <frame_cache.h>
+#include <frame_pacing.h>
+#include <frame_arena.h>
+#include <gl_resources.h>
+#include <lod.h>
+#include <asset_manager.h>
+#include <batch_render.h>
+#include <gpu_scene.h>
+#include <occlusion.h>
+#include <particles.h>
+#include <scene_depth.h>
+#include <shadows.h>
+#include <gpu_timer.h>
+#include <ibl.h>
+#include <temporal.h>
+#include <texture_arrays.h>
+#include <texture_streaming.h>
+#include <trace.h>
+#include <uniforms.h>
+
 #include <iostream>
+#include <memory>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
@@ -22,19 +44,28 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 
+void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
+
 void processInput(GLFWwindow *window);
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
 
-unsigned int loadTexture(char const * path);
 
-unsigned int loadCubemap(vector<std::string> faces);
+GlTexture loadCubemap(const vector<std::string> &faces);
 
 void renderQuad();
 
+void releaseQuad();
+
 // promenljive
 const unsigned int SCR_WIDTH = 900;
 const unsigned int SCR_HEIGHT = 667;
+// stencil vrednost piksela svetlecih kocki u hdrFBO
+const int emissiveStencil = 1;
+// skupovi svetala u mdi_lit.fs (isti parametri kao u pojedinacnim shaderima modela i podloge)
+const unsigned int ourLightSet = 0;
+const unsigned int smallLightSet = 1;
+const unsigned int surfaceLightSet = 2;
 bool bloom = true;
 float exposure = 0.9f;
 
@@ -45,6 +76,9 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// postavljaju ga glfw callback-ovi, brise se posle provere mirovanja u svakom frejmu
+bool inputActivity = false;
+
 struct PointLight {
     glm::vec3 position;
     glm::vec3 ambient;
@@ -65,12 +99,51 @@ struct ProgramState {
     glm::vec3 pokemonPosition = glm::vec3(1.0f);
     float pokemonScale = 1.0f;
     PointLight pointLight;
+    bool LodEnabled = true;
+    float LodPixelError = 1.0f;
+    bool StressSceneEnabled = false;
+    int StressGridSize = 20;
+    float AssetUploadBudgetMs = 2.0f;
+    int GpuMemoryWarningMB = 512;
+    bool MultiDrawEnabled = true;
+    bool GpuCullingEnabled = false;
+    bool DepthPrepassEnabled = false;
+    bool HiZCullingEnabled = false;
+    bool TemporalUpscalingEnabled = false;
+    bool DynamicResolutionEnabled = true;
+    float RenderScale = 1.0f;
+    float TargetFrameMs = 16.6f;
+    int TraceCaptureFrames = 300;
+    bool IblEnabled = true;
+    float IblIntensity = 1.0f;
+    int IdleRenderMode = (int) IdleMode::Off;
+    float IdleFps = 5.0f;
+    bool StaticLayerCacheEnabled = true;
+    bool ParticlesEnabled = true;
+    int ParticleBudget = 100000;
+    int ParticleThreads = 0;
+    float ParticleIntensity = 4.0f;
+    bool LowLatencyEnabled = false;
+    int MaxFramesInFlight = 1;
+    bool FrameLimiterEnabled = false;
+    float FrameLimiterFps = 60.0f;
+    bool VsyncEnabled = true;
+    int TextureBudgetMB = 256;
+    float TextureLodBias = 0.0f;
+    bool ShadowsEnabled = true;
+    bool ShadowCacheEnabled = true;
+    float ShadowStrength = 0.6f;
+    float ShadowDistance = 60.0f;
+    float ShadowCacheMargin = 0.25f;
     ProgramState()
             : camera(glm::vec3(-1.0f, 0.0f, 3.0f)) {}
 
     void SaveToFile(std::string filename);
 
     void LoadFromFile(std::string filename);
+
+    // sve od cega zavisi slika (osim vremena animacije i interne rezolucije)
+    void HashState(StateHash &hash) const;
 };
 
 void ProgramState::SaveToFile(std::string filename) {
@@ -103,19 +176,209 @@ void ProgramState::LoadFromFile(std::string filename) {
     }
 }
 
+void ProgramState::HashState(StateHash &hash) const {
+    hash.Add(clearColor);
+    hash.Add(ImGuiEnabled);
+    hash.Add(camera.Position);
+    hash.Add(camera.Front);
+    hash.Add(camera.Up);
+    hash.Add(camera.Zoom);
+    hash.Add(PokemonAttackMode);
+    hash.Add(pokemonPosition);
+    hash.Add(pokemonScale);
+    hash.Add(pointLight.constant);
+    hash.Add(pointLight.linear);
+    hash.Add(pointLight.quadratic);
+    hash.Add(LodEnabled);
+    hash.Add(LodPixelError);
+    hash.Add(StressSceneEnabled);
+    hash.Add(StressGridSize);
+    hash.Add(MultiDrawEnabled);
+    hash.Add(GpuCullingEnabled);
+    hash.Add(DepthPrepassEnabled);
+    hash.Add(HiZCullingEnabled);
+    hash.Add(TemporalUpscalingEnabled);
+    hash.Add(DynamicResolutionEnabled);
+    hash.Add(TargetFrameMs);
+    hash.Add(IblEnabled);
+    hash.Add(IblIntensity);
+    hash.Add(StaticLayerCacheEnabled);
+    hash.Add(ParticlesEnabled);
+    hash.Add(ParticleBudget);
+    hash.Add(ParticleIntensity);
+    hash.Add(TextureBudgetMB);
+    hash.Add(TextureLodBias);
+    hash.Add(ShadowsEnabled);
+    hash.Add(ShadowStrength);
+    hash.Add(ShadowDistance);
+}
+
 ProgramState *programState;
 
+// point light uniform promenljive; imena se formatiraju u areni frejma
+void setPointLight(const Shader &shader, int index, const PointLight &light,
+                   const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular) {
+    FrameArena &arena = ThreadFrameArena();
+    SetVec3(shader, arena.Format("pointLight[%d].position", index), light.position);
+    SetVec3(shader, arena.Format("pointLight[%d].ambient", index), ambient);
+    SetVec3(shader, arena.Format("pointLight[%d].diffuse", index), diffuse);
+    SetVec3(shader, arena.Format("pointLight[%d].specular", index), specular);
+    SetFloat(shader, arena.Format("pointLight[%d].constant", index), light.constant);
+    SetFloat(shader, arena.Format("pointLight[%d].linear", index), light.linear);
+    SetFloat(shader, arena.Format("pointLight[%d].quadratic", index), light.quadratic);
+}
+
+// usmereno svetlo skupa svetala (mdi_lit.fs)
+void setDirLight(const Shader &shader, int index, const glm::vec3 &direction,
+                 const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular) {
+    FrameArena &arena = ThreadFrameArena();
+    SetVec3(shader, arena.Format("dirLight[%d].direction", index), direction);
+    SetVec3(shader, arena.Format("dirLight[%d].ambient", index), ambient);
+    SetVec3(shader, arena.Format("dirLight[%d].diffuse", index), diffuse);
+    SetVec3(shader, arena.Format("dirLight[%d].specular", index), specular);
+}
+
+// statistika LOD-a za poslednji frejm
+struct LodStats {
+    unsigned int trianglesDrawn = 0;
+    unsigned int trianglesFull = 0;
+    unsigned int instances = 0;
+    unsigned int culled = 0;
+    unsigned int levelHistogram[4] = {0, 0, 0, 0};
+
+    void Reset() {
+        *this = LodStats();
+    }
+
+    void Count(const LodModel &lodModel, int level) {
+        if (lodModel.LevelCount() == 0)
+            return;
+        trianglesDrawn += lodModel.levelTriangles[level];
+        trianglesFull += lodModel.levelTriangles[0];
+        instances++;
+        levelHistogram[std::min(level, 3)]++;
+    }
+};
+LodStats lodStats;
+
+// jedna stavka liste za crtanje (alocira se u areni frejma)
+struct DrawPacket {
+    glm::mat4 model;
+    int *lodLevel;
+};
+
+// alokacije po frejmu: poziva operator new na render niti i zauzece arene
+struct FrameMemoryStats {
+    unsigned long long heapAllocations = 0;
+    size_t arenaUsed = 0;
+    float history[120] = {};
+    int historyIndex = 0;
+
+    void Push(unsigned long long allocations, size_t used) {
+        heapAllocations = allocations;
+        arenaUsed = used;
+        history[historyIndex] = (float) allocations;
+        historyIndex = (historyIndex + 1) % 120;
+    }
+};
+FrameMemoryStats frameMemoryStats;
+
+// MDI putanja (samo na GL 4.3+) i statistika poslednjeg frejma po prolazu
+struct MultiDrawState {
+    bool supported = false;
+    DrawBatchStats opaque;
+    DrawBatchStats emissive;
+    DrawBatchStats clouds;
+    DrawBatchStats shadows;
+    const TextureArrayManager *textureArrays = nullptr;
+};
+MultiDrawState multiDrawState;
+
+// Hi-Z odsecanje i senceni fragmenti neprozirnog prolaza za poslednji frejm
+struct OcclusionStats {
+    unsigned int tested = 0;
+    unsigned int occluded = 0;
+    unsigned long long fragmentsShaded = 0;
+};
+OcclusionStats occlusionStats;
+
+// interna rezolucija i vreme frejma na GPU za poslednji frejm
+struct ResolutionStats {
+    int renderWidth = SCR_WIDTH;
+    int renderHeight = SCR_HEIGHT;
+    float gpuFrameMs = 0.0f;
+};
+ResolutionStats resolutionStats;
+
+// mirovanje i kes statickih slojeva (za prikaz u ImGui)
+struct IdleState {
+    const IdleController *controller = nullptr;
+    const StaticLayerCache *staticLayers = nullptr;
+    bool idle = false;
+};
+IdleState idleState;
+
+// tempo frejmova i kasnjenje od ulaza do prikaza (za prikaz u ImGui)
+struct PacingState {
+    const FramePacer *pacer = nullptr;
+    const FrameLimiter *limiter = nullptr;
+};
+PacingState pacingState;
+
+// cestice napada i rezultati benchmark-a (za prikaz u ImGui)
+struct ParticleState {
+    ParticleSystem *system = nullptr;
+    // vrednosti klizaca; u ProgramState (i Configure) idu tek kada se klizac pusti
+    int budgetEdit = 0;
+    int threadsEdit = 0;
+    vector<ParticleBenchmarkResult> benchmark;
+};
+ParticleState particleState;
+
+// osvetljenje iz okoline (za prikaz u ImGui)
+const ImageBasedLighting *imageBasedLighting = nullptr;
+
+// strimovane teksture (za prikaz u ImGui)
+const TextureStreamer *textureStreamer = nullptr;
+
+// kaskadne senke (za prikaz u ImGui)
+const CascadedShadowMaps *cascadedShadowMaps = nullptr;
+
+AssetManager *assetManager;
+
 void DrawImGui(ProgramState *programState);
 
-int main() {
+int main(int argc, char **argv) {
+
+    // paketni rezim: --batch <fajl sa pozicijama> renderuje sve pozicije u skrivenom prozoru i izlazi
+    BatchOptions batchOptions;
+    vector<BatchPose> batchPoses;
+    std::string batchError;
+    if (!batch::ParseOptions(argc, argv, batchOptions, batchError)) {
+        std::cout << "Batch: " << batchError << std::endl;
+        return -1;
+    }
+    bool batchMode = batchOptions.enabled;
+    if (batchMode && !batch::LoadPoses(batchOptions.posesPath, batchPoses, batchError)) {
+        std::cout << "Batch: " << batchError << std::endl;
+        return -1;
+    }
 
     // glfw: inicijalizacija
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    if (batchMode)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL) {
+        // bez GL 4.5 konteksta radi samo stara putanja crtanja (bez MDI)
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    }
     if (window == NULL) {
         std::cout << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -125,6 +388,7 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetKeyCallback(window, key_callback);
 
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -134,10 +398,33 @@ int main() {
         return -1;
     }
 
+    // GL resursi napravljeni posle ovoga se unistavaju pre njega (obrnut redosled lokalnih promenljivih),
+    // pa se tek onda prijavljuje sta nije oslobodjeno i gasi kontekst
+    struct ContextGuard {
+        ~ContextGuard() {
+            GlResourceRegistry::Get().ReportLeaks(std::cout);
+            glfwTerminate();
+        }
+    } contextGuard;
+
+    multiDrawState.supported = MultiDrawSupported();
+    Tracer::Get().SetThreadName("render");
+
     //stbi_set_flip_vertically_on_load(true);
 
     programState = new ProgramState;
     programState->LoadFromFile("resources/program_state.txt");
+    GlResourceRegistry::Get().warningBytes = (size_t) programState->GpuMemoryWarningMB * 1024 * 1024;
+    if (batchMode) {
+        // svaka pozicija je rez kamere: bez istorije (TAA, Hi-Z iz proslih frejmova), cekanja i ImGui-ja
+        programState->ImGuiEnabled = false;
+        programState->TemporalUpscalingEnabled = false;
+        programState->HiZCullingEnabled = false;
+        programState->IdleRenderMode = (int) IdleMode::Off;
+        programState->LowLatencyEnabled = false;
+        programState->FrameLimiterEnabled = false;
+        programState->VsyncEnabled = false;
+    }
     if (programState->ImGuiEnabled) {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
     }
@@ -155,8 +442,10 @@ int main() {
     glEnable(GL_CULL_FACE);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
     // buildovanje shadera
+    TraceZone shaderZone("Compile shaders", "shader");
     Shader ourShader("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs");
     Shader smallShader("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs");
 
@@ -168,13 +457,66 @@ int main() {
 
     Shader shaderBlur("resources/shaders/blur.vs", "resources/shaders/blur.fs");
     Shader shaderBloomFinal("resources/shaders/bloom_final.vs", "resources/shaders/bloom_final.fs");
-
-    // ucitavanje modela
-    Model ourModel("resources/objects/chin/Resultado.obj");
-    ourModel.SetShaderTextureNamePrefix("material.");
-
-    Model smallModel("resources/objects/chin2/Resultado.obj");
-    smallModel.SetShaderTextureNamePrefix("material.");
+    Shader placeholderShader("resources/shaders/placeholder.vs", "resources/shaders/placeholder.fs");
+    Shader depthShader("resources/shaders/depth_prepass.vs", "resources/shaders/depth_prepass.fs");
+    Shader hizShader("resources/shaders/hiz.vs", "resources/shaders/hiz.fs");
+    Shader taaShader("resources/shaders/taa.vs", "resources/shaders/taa.fs");
+    Shader particleShader("resources/shaders/particle.vs", "resources/shaders/particle.fs");
+    Shader shadowResolveShader("resources/shaders/shadow_resolve.vs", "resources/shaders/shadow_resolve.fs");
+
+    // Shader ne brise svoj program, vlasnistvo preuzimaju GlProgram omotaci
+    GlProgram ourProgram = GlProgram::Adopt(ourShader.ID, "ourShader");
+    GlProgram smallProgram = GlProgram::Adopt(smallShader.ID, "smallShader");
+    GlProgram skyboxProgram = GlProgram::Adopt(skyboxShader.ID, "skyboxShader");
+    GlProgram surfaceProgram = GlProgram::Adopt(surfaceShader.ID, "surfaceShader");
+    GlProgram pinkProgram = GlProgram::Adopt(pinkShader.ID, "pinkShader");
+    GlProgram yellowProgram = GlProgram::Adopt(yellowShader.ID, "yellowShader");
+    GlProgram cloudProgram = GlProgram::Adopt(cloudShader.ID, "cloudShader");
+    GlProgram blurProgram = GlProgram::Adopt(shaderBlur.ID, "shaderBlur");
+    GlProgram bloomFinalProgram = GlProgram::Adopt(shaderBloomFinal.ID, "shaderBloomFinal");
+    GlProgram placeholderProgram = GlProgram::Adopt(placeholderShader.ID, "placeholderShader");
+    GlProgram depthProgram = GlProgram::Adopt(depthShader.ID, "depthShader");
+    GlProgram hizProgram = GlProgram::Adopt(hizShader.ID, "hizShader");
+    GlProgram taaProgram = GlProgram::Adopt(taaShader.ID, "taaShader");
+    GlProgram particleProgram = GlProgram::Adopt(particleShader.ID, "particleShader");
+    GlProgram shadowResolveProgram = GlProgram::Adopt(shadowResolveShader.ID, "shadowResolveShader");
+
+    // shaderi za MDI (GLSL 4.30: SSBO + compute), prave se samo ako ih kontekst podrzava
+    std::unique_ptr<Shader> mdiLitShader, mdiEmissiveShader, mdiDepthShader, mdiCloudShader;
+    GlProgram mdiLitProgram, mdiEmissiveProgram, mdiDepthProgram, mdiCloudProgram, mdiCullProgram;
+    if (multiDrawState.supported) {
+        mdiLitShader.reset(new Shader("resources/shaders/mdi_lit.vs", "resources/shaders/mdi_lit.fs"));
+        mdiEmissiveShader.reset(new Shader("resources/shaders/mdi_emissive.vs", "resources/shaders/mdi_emissive.fs"));
+        mdiLitProgram = GlProgram::Adopt(mdiLitShader->ID, "mdiLitShader");
+        mdiEmissiveProgram = GlProgram::Adopt(mdiEmissiveShader->ID, "mdiEmissiveShader");
+        mdiDepthShader.reset(new Shader("resources/shaders/mdi_depth.vs", "resources/shaders/mdi_depth.fs"));
+        mdiDepthProgram = GlProgram::Adopt(mdiDepthShader->ID, "mdiDepthShader");
+        mdiCloudShader.reset(new Shader("resources/shaders/mdi_cloud.vs", "resources/shaders/mdi_cloud.fs"));
+        mdiCloudProgram = GlProgram::Adopt(mdiCloudShader->ID, "mdiCloudShader");
+        mdiCullProgram = LoadComputeProgram("resources/shaders/mdi_cull.cs");
+    }
+    shaderZone.End();
+
+    // ucitavanje modela: import u pozadini, otpremanje na GPU postepeno u toku frejmova;
+    // za MDI se teksture pakuju i u nizove tekstura (materijal = indeks sloja)
+    // teksture modela i scene se strimuju po mip nivoima u okviru budzeta (nizovi tekstura za MDI ostaju ceo)
+    TextureArrayManager textureArrays;
+    TextureStreamer streamer;
+    textureStreamer = &streamer;
+    assetManager = new AssetManager;
+    if (multiDrawState.supported)
+        assetManager->EnableTextureArrays(&textureArrays);
+    assetManager->EnableStreaming(&streamer);
+    ModelHandle ourModel = assetManager->LoadModel("resources/objects/chin/Resultado.obj", "material.");
+    ModelHandle smallModel = assetManager->LoadModel("resources/objects/chin2/Resultado.obj", "material.");
+
+    // LOD nivoi modela (quadric error metrics) + izbor nivoa po gresci na ekranu
+    LodModel &ourLod = assetManager->Get(ourModel).lod;
+    LodModel &smallLod = assetManager->Get(smallModel).lod;
+    LodSelector lodSelector;
+    int ourLodLevel = 0;
+    int smallLodLevel = 0;
+    vector<int> stressLodLevels;
 
     // pointLight konstante
     PointLight& pointLight = programState->pointLight;
@@ -230,13 +572,11 @@ int main() {
 
     };
 
-    unsigned int VBO_surface, VAO_surface;
-    glGenVertexArrays(1, &VAO_surface);
-    glGenBuffers(1, &VBO_surface);
+    GlVertexArray VAO_surface = GlVertexArray::Create("VAO_surface");
+    GlBuffer VBO_surface = GlBuffer::Create("VBO_surface");
 
     glBindVertexArray(VAO_surface);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_surface);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    GlBufferData(VBO_surface, GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
@@ -245,7 +585,8 @@ int main() {
     glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8* sizeof(float), (void*)(5*sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    unsigned int surface_texture = loadTexture(FileSystem::getPath("resources/textures/zuto.jpg").c_str());
+    int surfaceTextureHandle = streamer.Load(FileSystem::getPath("resources/textures/zuto.jpg"), true, false);
+    unsigned int surface_texture = streamer.TextureId(surfaceTextureHandle);
 
     surfaceShader.use();
     surfaceShader.setInt("texture_diffuse1", 0);
@@ -272,34 +613,60 @@ int main() {
             1.0f,  0.5f,  0.0f,     1.0f,  0.0f
     };
 
-    unsigned int planeVAO, planeVBO;
-    glGenVertexArrays(1, &planeVAO);
-    glGenBuffers(1, &planeVBO);
+    GlVertexArray planeVAO = GlVertexArray::Create("planeVAO");
+    GlBuffer planeVBO = GlBuffer::Create("planeVBO");
     glBindVertexArray(planeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, planeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
+    GlBufferData(planeVBO, GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 
-    unsigned int transparentVAO, transparentVBO;
-    glGenVertexArrays(1, &transparentVAO);
-    glGenBuffers(1, &transparentVBO);
+    GlVertexArray transparentVAO = GlVertexArray::Create("transparentVAO");
+    GlBuffer transparentVBO = GlBuffer::Create("transparentVBO");
     glBindVertexArray(transparentVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, transparentVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(transparentVertices), transparentVertices, GL_STATIC_DRAW);
+    GlBufferData(transparentVBO, GL_ARRAY_BUFFER, sizeof(transparentVertices), transparentVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     glBindVertexArray(0);
 
-    unsigned int transparentTexture = loadTexture(FileSystem::getPath("resources/textures/roze4.png").c_str());
+    // GL_CLAMP_TO_EDGE: bez poluprovidnih ivica od interpolacije sa suprotnom stranom
+    int cloudTextureHandle = streamer.Load(FileSystem::getPath("resources/textures/roze4.png"), true, true);
+    unsigned int transparentTexture = streamer.TextureId(cloudTextureHandle);
 
     cloudShader.use();
     cloudShader.setInt("texture1", 0);
 
+    // MDI: kocka, oblak i (kad se ucitaju) modeli u spojenom baferu geometrije; teksture podloge i
+    // oblaka su slojevi nizova tekstura, kao teksture modela
+    GpuScene gpuScene;
+    GpuModel ourGpuModel, smallGpuModel;
+    DrawBatch opaqueBatch("opaque");            // modeli, podloge i stress instance
+    DrawBatch staticBatch("static layers");     // podloge pri snimanju statickih slojeva
+    DrawBatch emissiveBatch("emissive");
+    DrawBatch cloudBatch("clouds");
+    DrawBatch shadowBatch("shadow casters");
+    GeometryRange cubeRange, cloudRange;
+    unsigned int surfaceMaterial = 0, cloudMaterial = 0;
+    gpuScene.textureArrays = &textureArrays;
+    multiDrawState.textureArrays = &textureArrays;
+    if (multiDrawState.supported) {
+        cubeRange = AddInterleavedGeometry(gpuScene, vertices, 36);
+        cloudRange = AddTexturedGeometry(gpuScene, transparentVertices, 6, glm::vec3(0.0f, 0.0f, 1.0f));
+        surfaceMaterial = gpuScene.AddMaterial(LoadTextureLayer(textureArrays, FileSystem::getPath("resources/textures/zuto.jpg"), true),
+                                               TextureLayer(), 126.0f, surfaceLightSet);
+        cloudMaterial = gpuScene.AddMaterial(LoadTextureLayer(textureArrays, FileSystem::getPath("resources/textures/roze4.png"), true),
+                                             TextureLayer());
+        gpuScene.Commit();
+        mdiLitShader->use();
+        mdiLitShader->setInt("diffuseTextures", 0);
+        mdiLitShader->setInt("specularTextures", 1);
+        mdiCloudShader->use();
+        mdiCloudShader->setInt("diffuseTextures", 0);
+    }
+
 
     // POZICIONIRANJA
 
@@ -383,32 +750,45 @@ int main() {
             1.0f, -1.0f,  1.0f
     };
 
-    unsigned int skyboxVAO, skyboxVBO;
-    glGenVertexArrays(1, &skyboxVAO);
-    glGenBuffers(1, &skyboxVBO);
+    GlVertexArray skyboxVAO = GlVertexArray::Create("skyboxVAO");
+    GlBuffer skyboxVBO = GlBuffer::Create("skyboxVBO");
     glBindVertexArray(skyboxVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
+    GlBufferData(skyboxVBO, GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    unsigned int cubemapTexture = loadCubemap(faces);
+    GlTexture cubemapTexture = loadCubemap(faces);
+
+    // IBL iz skybox-a: ucitava se iz kesa, racuna se samo kada se slike strana promene
+    ImageBasedLighting environmentLighting;
+    environmentLighting.Load(faces, cubemapTexture, skyboxVAO);
+    imageBasedLighting = &environmentLighting;
+    const int iblTextureUnit = 8;
+    auto applyIbl = [&](Shader &shader) {
+        environmentLighting.Apply(shader, iblTextureUnit, programState->IblIntensity);
+        SetInt(shader, "iblEnabled", programState->IblEnabled);
+    };
 
     skyboxShader.use();
     skyboxShader.setInt("skybox", 0);
 
 
+    // velicina ciljeva scene (hdr, bloom, dubina, Hi-Z, TAA, staticki slojevi): u paketnom rezimu sa --tile
+    // velicina polja atlasa, pa se scena renderuje u rezoluciji i odnosu stranica polja
+    const int frameWidth = batchMode && batchOptions.tileWidth > 0 ? batchOptions.tileWidth : (int) SCR_WIDTH;
+    const int frameHeight = batchMode && batchOptions.tileHeight > 0 ? batchOptions.tileHeight : (int) SCR_HEIGHT;
+
     // frame buffers: hdr & bloom
-    unsigned int hdrFBO;
-    glGenFramebuffers(1, &hdrFBO);
+    GlFramebuffer hdrFBO = GlFramebuffer::Create("hdrFBO");
     glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
     // 2 color buffers
-    unsigned int colorBuffers[2];
-    glGenTextures(2, colorBuffers);
+    GlTexture colorBuffers[2];
     for (unsigned int i = 0; i < 2; i++)
     {
+        colorBuffers[i] = GlTexture::Create("colorBuffers[" + std::to_string(i) + "]");
+        colorBuffers[i].SetBytes(EstimateTextureBytes(GL_RGBA16F, frameWidth, frameHeight));
         glBindTexture(GL_TEXTURE_2D, colorBuffers[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, frameWidth, frameHeight, 0, GL_RGBA, GL_FLOAT, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -416,12 +796,13 @@ int main() {
 
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colorBuffers[i], 0);
     }
-    // depth buffer (renderbuffer)
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
+    // depth + stencil buffer (renderbuffer); stencil oznacava svetlece kocke koje senke preskacu
+    GlRenderbuffer rboDepth = GlRenderbuffer::Create("rboDepth");
+    rboDepth.SetBytes(EstimateTextureBytes(GL_DEPTH24_STENCIL8, frameWidth, frameHeight));
     glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+    // eksplicitan format, da bi se dubina mogla kopirati (blit) u teksturu istog formata (scene_depth.h)
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, frameWidth, frameHeight);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
 
     unsigned int attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
     glDrawBuffers(2, attachments);
@@ -431,15 +812,16 @@ int main() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // ping-pong-framebuffer
-    unsigned int pingpongFBO[2];
-    unsigned int pingpongColorbuffers[2];
-    glGenFramebuffers(2, pingpongFBO);
-    glGenTextures(2, pingpongColorbuffers);
+    GlFramebuffer pingpongFBO[2];
+    GlTexture pingpongColorbuffers[2];
     for (unsigned int i = 0; i < 2; i++)
     {
+        pingpongFBO[i] = GlFramebuffer::Create("pingpongFBO[" + std::to_string(i) + "]");
+        pingpongColorbuffers[i] = GlTexture::Create("pingpongColorbuffers[" + std::to_string(i) + "]");
+        pingpongColorbuffers[i].SetBytes(EstimateTextureBytes(GL_RGBA16F, frameWidth, frameHeight));
         glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
         glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, frameWidth, frameHeight, 0, GL_RGBA, GL_FLOAT, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -456,21 +838,664 @@ int main() {
     shaderBloomFinal.setInt("scene", 0);
     shaderBloomFinal.setInt("bloomBlur", 1);
 
+    // jedna kopija dubine po frejmu za Hi-Z, senke i TAA
+    SceneDepthCopy sceneDepth(frameWidth, frameHeight);
+
+    // Hi-Z piramida (dubina prethodnog frejma) i brojac senecenih fragmenata
+    HiZBuffer hiZ(frameWidth, frameHeight);
+    SamplesPassedCounter overdrawCounter;
+
+    // kaskadne senke usmerenog svetla sa kesom statickih bacaca
+    CascadedShadowMaps shadowMaps;
+    shadowMaps.SetLight(glm::vec3(0.0f, -5.0f, -15.0f));
+    cascadedShadowMaps = &shadowMaps;
+
+    // temporal upscaling (interna rezolucija 50-100%) i kontroler skale po vremenu frejma na GPU
+    TemporalUpscaler upscaler(frameWidth, frameHeight);
+    DynamicResolution dynamicResolution;
+    unsigned int resolutionSample = 0;      // poslednje merenje frameTimer-a koje je videla dinamicka rezolucija
+    GpuTimer frameTimer("frame");
+    GpuTraceZones gpuTrace;
+
+    // podloge i skybox se crtaju jednom dok se pogled ne promeni; mirna scena se proredjuje ili zamrzava
+    StaticLayerCache staticLayers(frameWidth, frameHeight);
+    IdleController idleController;
+    uint64_t lastStaticSignature = 0;
+    idleState.controller = &idleController;
+    idleState.staticLayers = &staticLayers;
+
+    // cestice napada: simulacija na CPU (SSE + radne niti), bilbordi u hdrFBO
+    ParticleSystem particles(programState->ParticleBudget, programState->ParticleThreads);
+    ParticleRenderer particleRenderer;
+    GpuIntervalTimer particleTimer("particles");
+    particleState.system = &particles;
+    particleState.budgetEdit = programState->ParticleBudget;
+    particleState.threadsEdit = programState->ParticleThreads;
+
+    // tempo frejmova: fence posle svakog swap-a, ogranicenje broja frejmova (sleep + spin)
+    FramePacer framePacer;
+    FrameLimiter frameLimiter;
+    int swapInterval = -1;
+    pacingState.pacer = &framePacer;
+    pacingState.limiter = &frameLimiter;
+
+    std::unique_ptr<BatchRenderer> batchRenderer;
+    if (batchMode)
+        batchRenderer.reset(new BatchRenderer(batchOptions, batchPoses, frameWidth, frameHeight));
+
     while (!glfwWindowShouldClose(window)) {
 
+        // arena frejma i brojac alokacija se resetuju na pocetku svakog frejma
+        ThreadFrameArena().Reset();
+        unsigned long long frameAllocationsStart = HeapAllocationCount();
+
+        // vremenska linija: kraj snimanja zadatog broja frejmova, GPU zone od pre par frejmova
+        Tracer::Get().FrameMark();
+        gpuTrace.BeginFrame();
+        TraceZone frameZone("Frame");
+
+        // low latency: najvise MaxFramesInFlight frejmova na GPU, a ulaz se cita tek posle svih cekanja
+        {
+            TraceZone pacingZone("Frame pacing");
+            if (swapInterval != (int) programState->VsyncEnabled) {
+                swapInterval = programState->VsyncEnabled;
+                glfwSwapInterval(swapInterval);
+            }
+            framePacer.Retire();
+            if (programState->LowLatencyEnabled)
+                framePacer.WaitForFrames(programState->MaxFramesInFlight);
+            else
+                framePacer.fenceWaitMs = 0.0f;
+            if (programState->FrameLimiterEnabled)
+                frameLimiter.Wait(programState->FrameLimiterFps);
+            else
+                frameLimiter.Reset();
+            if (programState->LowLatencyEnabled) {
+                glfwPollEvents();
+                framePacer.MarkInput();
+            }
+        }
+
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
         // input
+        TraceZone inputZone("Input");
         processInput(window);
+        inputZone.End();
+
+        // paketni rezim: kamera i podesavanja tekuce pozicije
+        if (batchRenderer) {
+            const BatchPose &pose = batchRenderer->Current();
+            Camera &camera = programState->camera;
+            camera.Position = pose.position;
+            camera.Yaw = pose.yaw;
+            camera.Pitch = pose.pitch;
+            camera.Zoom = pose.fov;
+            camera.ProcessMouseMovement(0.0f, 0.0f);    // preracunava Front, Right i Up
+            exposure = pose.exposure;
+            bloom = pose.bloom;
+            programState->PokemonAttackMode = pose.attack;
+        }
+
+        // otpremanje ucitanih modela u okviru budzeta za ovaj frejm
+        assetManager->Update(programState->AssetUploadBudgetMs);
+
+        // mirovanje: stanje se ne menja i nema ulaza, napada, ucitavanja ni snimanja vremenske linije
+        StateHash stateHash;
+        programState->HashState(stateHash);
+        bool activity = inputActivity || programState->PokemonAttackMode || particles.Alive() > 0 || Tracer::Get().Enabled() ||
+                        !assetManager->IsSettled(ourModel) || !assetManager->IsSettled(smallModel) || streamer.Busy();
+        inputActivity = false;
+        IdleMode idleMode = (IdleMode) programState->IdleRenderMode;
+        bool idle = idleController.Update(stateHash.Value(), activity) && idleMode != IdleMode::Off;
+        idleState.idle = idle;
+        if (idle && idleMode == IdleMode::Freeze) {
+            // poslednja slika ostaje u prozoru; timeout samo da bi se ponovo proverilo stanje
+            idleController.skippedFrames++;
+            glfwWaitEventsTimeout(0.25);
+            lastFrame = glfwGetTime();
+            continue;
+        }
+        idleController.renderedFrames++;
+
+        // interna rezolucija ovog frejma
+        bool temporal = programState->TemporalUpscalingEnabled;
+        // isto merenje stoji vise frejmova dok ne stigne sledeci upit, a racuna se samo jednom
+        if (temporal && programState->DynamicResolutionEnabled && frameTimer.Samples() != resolutionSample) {
+            resolutionSample = frameTimer.Samples();
+            programState->RenderScale = dynamicResolution.Update(programState->RenderScale, frameTimer.Milliseconds(),
+                                                                 programState->TargetFrameMs);
+        }
+        upscaler.BeginFrame(temporal ? programState->RenderScale : 1.0f);
+        glm::ivec2 renderSize = temporal ? upscaler.RenderSize() : glm::ivec2(frameWidth, frameHeight);
+        resolutionStats.renderWidth = renderSize.x;
+        resolutionStats.renderHeight = renderSize.y;
+        resolutionStats.gpuFrameMs = frameTimer.Milliseconds();
+        TraceCounter("CPU frame (ms)", deltaTime * 1000.0);
+        TraceCounter("GPU frame (ms)", frameTimer.Milliseconds());
+        TraceCounter("Render scale", temporal ? programState->RenderScale : 1.0f);
+
+        lodStats.Reset();
+        lodSelector.pixelError = programState->LodPixelError;
+        lodSelector.SetProjection(glm::radians(programState->camera.Zoom), (float) renderSize.y);
+
+        bool useMultiDraw = multiDrawState.supported && programState->MultiDrawEnabled;
+        multiDrawState.opaque = DrawBatchStats();
+        multiDrawState.emissive = DrawBatchStats();
+        multiDrawState.clouds = DrawBatchStats();
+        multiDrawState.shadows = DrawBatchStats();
+
+        // modeli idu u spojeni bafer kada se ucitaju do kraja; dok se ucitavaju crtaju se pojedinacno
+        if (useMultiDraw) {
+            if (!ourGpuModel.registered && assetManager->IsResident(ourModel)) {
+                ourGpuModel.Register(gpuScene, assetManager->Get(ourModel), 256.0f, ourLightSet);
+                gpuScene.Commit();
+            }
+            if (!smallGpuModel.registered && assetManager->IsResident(smallModel)) {
+                smallGpuModel.Register(gpuScene, assetManager->Get(smallModel), 256.0f, smallLightSet);
+                gpuScene.Commit();
+            }
+        }
+        bool ourMultiDraw = useMultiDraw && ourGpuModel.registered;
+        bool smallMultiDraw = useMultiDraw && smallGpuModel.registered;
+        opaqueBatch.Clear();
+
+        // ------------------------------------------------------------------------------------------------------------------------
+        // PRIPREMA FREJMA: matrice, LOD nivoi i liste za crtanje (isti su za depth pre-pass i glavni prolaz)
+        // ------------------------------------------------------------------------------------------------------------------------
+        TraceZone prepareZone("Prepare frame");
+
+        // matrice transformacija: view, projection
+        glm::mat4 projection = glm::perspective(glm::radians(programState->camera.Zoom),
+                                                (float) frameWidth / (float) frameHeight, 0.3f, 500.0f);
+        glm::mat4 view = programState->camera.GetViewMatrix();
+        Frustum viewFrustum(projection * view);
+
+        // projekcija bez jittera ostaje za reprojekciju istorije
+        glm::mat4 unjitteredViewProjection = projection * view;
+        if (temporal)
+            projection = upscaler.JitterProjection(projection);
+
+        // Hi-Z test sfere prema dubini iz prethodnih frejmova
+        hiZ.FetchReadback();
+        occlusionStats.tested = 0;
+        occlusionStats.occluded = 0;
+        auto isOccluded = [&](const glm::vec3 &center, float radius) {
+            if (!programState->HiZCullingEnabled)
+                return false;
+            occlusionStats.tested++;
+            if (!hiZ.IsOccluded(center, radius))
+                return false;
+            occlusionStats.occluded++;
+            return true;
+        };
+
+        // plavi model
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model,programState->pokemonPosition);
+        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0, 1.0, 0.0));
+        model = glm::scale(model, glm::vec3(programState->pokemonScale));
+        ourLodLevel = programState->LodEnabled
+                ? lodSelector.Select(ourLod, ourLodLevel, model, programState->pokemonScale, programState->camera.Position)
+                : 0;
+        bool ourVisible = !isOccluded(glm::vec3(model * glm::vec4(ourLod.center, 1.0f)), ourLod.radius * programState->pokemonScale);
+
+        // ljubicasti model
+        glm::mat4 model1 = glm::mat4(1.0f);
+        model1 = glm::translate(model1,programState->pokemonPosition);
+        model1 = glm::translate(model1, glm::vec3(30.0, 0.0, 0.0));
+        model1 = glm::rotate(model1, glm::radians(270.0f), glm::vec3(0.0, 1.0, 0.0));
+        model1 = glm::scale(model1, glm::vec3(programState->pokemonScale));
+        model1 = glm::scale(model1, glm::vec3(0.5, 0.5, 0.5));
+        smallLodLevel = programState->LodEnabled
+                ? lodSelector.Select(smallLod, smallLodLevel, model1, programState->pokemonScale * 0.5f, programState->camera.Position)
+                : 0;
+        bool smallVisible = !isOccluded(glm::vec3(model1 * glm::vec4(smallLod.center, 1.0f)),
+                                        smallLod.radius * programState->pokemonScale * 0.5f);
+        if (ourMultiDraw && ourVisible)
+            ourGpuModel.Add(opaqueBatch, model, programState->pokemonScale, ourLodLevel);
+        if (smallMultiDraw && smallVisible)
+            smallGpuModel.Add(opaqueBatch, model1, programState->pokemonScale * 0.5f, smallLodLevel);
+
+        // cestice: izvori su oba modela; posle napada postojece cestice dogore
+        {
+            TraceZone particleZone("Particles update", "particles");
+            particles.Configure(programState->ParticleBudget, programState->ParticleThreads);
+            ParticleEmitter emitters[2];
+            emitters[0].position = glm::vec3(model * glm::vec4(ourLod.center, 1.0f));
+            emitters[0].radius = ourLod.radius * programState->pokemonScale * 0.8f;
+            emitters[1].position = glm::vec3(model1 * glm::vec4(smallLod.center, 1.0f));
+            emitters[1].radius = smallLod.radius * programState->pokemonScale * 0.4f;
+            particles.SetEmitters(emitters, 2);
+            if (programState->ParticlesEnabled)
+                particles.Update(std::min(deltaTime, 0.1f), programState->PokemonAttackMode);
+            else
+                particles.Clear();
+            particleRenderer.Upload(particles);
+            TraceCounter("Particles", particles.Alive());
+        }
+
+        // kocke ispod modela
+        glm::mat4 surface_model = glm::mat4(1.0f);
+        surface_model = glm::translate(surface_model, glm::vec3(1.0f, -0.9f, 1.5f));
+        surface_model = glm::scale(surface_model, glm::vec3(8.0, 4.0, 8.0));
+        glm::mat4 small_surface_model = glm::translate(surface_model, glm::vec3(3.72f, 0.25f, -0.07f));
+        small_surface_model = glm::scale(small_surface_model, glm::vec3(0.5, 0.5, 0.5));
+
+        // stress scena: mreza instanci malog modela (provera propusnosti trouglova sa/bez LOD-a);
+        // instance van frustuma ili iza Hi-Z dubine se ne salju, a za MDI idu u opaqueBatch
+        bool stressActive = programState->StressSceneEnabled && assetManager->IsResident(smallModel);
+        bool stressMultiDraw = stressActive && smallMultiDraw;
+        FrameVector<DrawPacket> packets;
+        if (stressActive) {
+            const int grid = programState->StressGridSize;
+            stressLodLevels.resize(grid * grid, 0);
+            packets.reserve(grid * grid);
+
+            // sa GPU odsecanjem frustum proverava compute shader
+            bool cpuFrustum = !(stressMultiDraw && programState->GpuCullingEnabled);
+            for (int i = 0; i < grid; i++) {
+                for (int j = 0; j < grid; j++) {
+                    glm::mat4 stress_model = glm::mat4(1.0f);
+                    stress_model = glm::translate(stress_model, glm::vec3(-40.0f + 6.0f * i, -14.0f, -40.0f + 6.0f * j));
+                    stress_model = glm::rotate(stress_model, glm::radians(30.0f * (i + j)), glm::vec3(0.0, 1.0, 0.0));
+                    stress_model = glm::scale(stress_model, glm::vec3(0.5f));
+
+                    glm::vec3 center = glm::vec3(stress_model * glm::vec4(smallLod.center, 1.0f));
+                    if (cpuFrustum && !viewFrustum.TestSphere(center, smallLod.radius * 0.5f)) {
+                        lodStats.culled++;
+                        continue;
+                    }
+                    if (isOccluded(center, smallLod.radius * 0.5f))
+                        continue;
+
+                    int &level = stressLodLevels[i * grid + j];
+                    level = programState->LodEnabled
+                            ? lodSelector.Select(smallLod, level, stress_model, 0.5f, programState->camera.Position)
+                            : 0;
+                    if (stressMultiDraw)
+                        smallGpuModel.Add(opaqueBatch, stress_model, 0.5f, level);
+                    else
+                        packets.push_back({stress_model, &level});
+                    lodStats.Count(smallLod, level);
+                }
+            }
+        }
+
+        // strimovanje tekstura: detaljnost prema velicini na ekranu povrsine preko koje se tekstura razvlaci
+        {
+            auto projectedPixels = [&](const glm::vec3 &center, float extent) {
+                float distance = glm::length(programState->camera.Position - center) - 0.5f * extent;
+                return lodSelector.ScreenError(extent, 1.0f, distance);
+            };
+            float ourExtent = 2.0f * ourLod.radius * programState->pokemonScale;
+            float smallExtent = 2.0f * smallLod.radius * programState->pokemonScale * 0.5f;
+            if (ourVisible)
+                assetManager->RequestTextures(ourModel, projectedPixels(glm::vec3(model * glm::vec4(ourLod.center, 1.0f)), ourExtent));
+            if (smallVisible || stressActive)
+                assetManager->RequestTextures(smallModel, projectedPixels(glm::vec3(model1 * glm::vec4(smallLod.center, 1.0f)), smallExtent));
+            // stranica kocke je 8 jedinica; mala kocka je upola manja
+            streamer.Request(surfaceTextureHandle, projectedPixels(glm::vec3(surface_model[3]), 8.0f));
+            float cloudPixels = 0.0f;
+            for (unsigned int i = 0; i < cloud_positions.size(); i++)
+                cloudPixels = std::max(cloudPixels, projectedPixels(cloud_positions[i], 7.0f + i));
+            streamer.Request(cloudTextureHandle, cloudPixels);
+
+            streamer.budgetBytes = (size_t) programState->TextureBudgetMB * 1024 * 1024;
+            streamer.lodBias = programState->TextureLodBias;
+            streamer.Update();
+        }
+
+        // staticki slojevi: potpis pogleda; sa temporal upscaling-om se projekcija pomera svaki frejm
+        StateHash staticHash;
+        staticHash.Add(projection);
+        staticHash.Add(view);
+        staticHash.Add(programState->clearColor);
+        staticHash.Add(programState->IblEnabled);
+        staticHash.Add(programState->IblIntensity);
+        staticHash.Add(useMultiDraw);
+        staticHash.Add(streamer.ResidentLevel(surfaceTextureHandle));
+        uint64_t staticSignature = staticHash.Value();
+        bool staticStable = staticSignature == lastStaticSignature;
+        lastStaticSignature = staticSignature;
+        bool staticCached = false;
+        if (!programState->StaticLayerCacheEnabled || temporal)
+            staticLayers.Invalidate();
+        else
+            staticCached = staticLayers.Matches(staticSignature) || staticStable;
+
+        // podloge u MDI listi (sa kesom su vec u kompozitu statickih slojeva)
+        if (useMultiDraw && !staticCached) {
+            opaqueBatch.Add(cubeRange, surface_model, glm::vec4(1.0f), surfaceMaterial, 8.0f);
+            opaqueBatch.Add(cubeRange, small_surface_model, glm::vec4(1.0f), surfaceMaterial, 4.0f);
+        }
+
+        // kaskadne senke: staticki bacaci se kesiraju po kaskadi, pokretni (modeli i svetlece kocke) crtaju svaki frejm
+        bool shadows = programState->ShadowsEnabled;
+        if (shadows) {
+            StateHash shadowHash;
+            shadowHash.Add(stressActive);
+            shadowHash.Add(programState->StressGridSize);
+            shadowMaps.Fit(programState->camera.Position, 0.3f, programState->ShadowDistance,
+                           programState->ShadowCacheMargin, programState->ShadowCacheEnabled, shadowHash.Value());
+        }
+        // MDI bacaci senki: jedan Submit po kaskadi, bez GPU odsecanja (frustum svetla nije frustum kamere)
+        auto submitShadowBatch = [&](const glm::mat4 &lightViewProjection) {
+            mdiDepthShader->use();
+            SetMat4(*mdiDepthShader, "projection", lightViewProjection);
+            SetMat4(*mdiDepthShader, "view", glm::mat4(1.0f));
+            shadowBatch.Submit(gpuScene, *mdiDepthShader, Frustum(lightViewProjection), false, mdiCullProgram, false);
+            multiDrawState.shadows.draws += shadowBatch.stats.draws;
+            multiDrawState.shadows.submitted += shadowBatch.stats.submitted;
+            multiDrawState.shadows.multiDrawCalls += shadowBatch.stats.multiDrawCalls;
+        };
+        auto drawStaticCasters = [&](const glm::mat4 &lightViewProjection) {
+            if (useMultiDraw) {
+                shadowBatch.Clear();
+                shadowBatch.Add(cubeRange, surface_model, glm::vec4(1.0f), surfaceMaterial, 8.0f);
+                shadowBatch.Add(cubeRange, small_surface_model, glm::vec4(1.0f), surfaceMaterial, 4.0f);
+                for (unsigned int i = 0; i < 10; i++) {
+                    glm::mat4 cube_model = glm::scale(glm::translate(glm::mat4(1.0f), cubePositions[i]), glm::vec3(0.3f));
+                    shadowBatch.Add(cubeRange, cube_model, glm::vec4(1.0f), 0, 0.3f);
+                }
+                if (stressMultiDraw) {
+                    const int grid = programState->StressGridSize;
+                    int level = std::min(2, smallLod.LevelCount() - 1);
+                    for (int i = 0; i < grid; i++) {
+                        for (int j = 0; j < grid; j++) {
+                            glm::mat4 stress_model = glm::mat4(1.0f);
+                            stress_model = glm::translate(stress_model, glm::vec3(-40.0f + 6.0f * i, -14.0f, -40.0f + 6.0f * j));
+                            stress_model = glm::rotate(stress_model, glm::radians(30.0f * (i + j)), glm::vec3(0.0, 1.0, 0.0));
+                            stress_model = glm::scale(stress_model, glm::vec3(0.5f));
+                            smallGpuModel.Add(shadowBatch, stress_model, 0.5f, level);
+                        }
+                    }
+                }
+                submitShadowBatch(lightViewProjection);
+                return;
+            }
+            depthShader.use();
+            SetMat4(depthShader, "projection", lightViewProjection);
+            SetMat4(depthShader, "view", glm::mat4(1.0f));
+            glBindVertexArray(VAO_surface);
+            SetMat4(depthShader, "model", surface_model);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            SetMat4(depthShader, "model", small_surface_model);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            for (unsigned int i = 0; i < 10; i++) {
+                glm::mat4 cube_model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
+                SetMat4(depthShader, "model", glm::scale(cube_model, glm::vec3(0.3f)));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            // cela mreza (i van frustuma kamere), u grubom LOD nivou
+            if (stressActive) {
+                const int grid = programState->StressGridSize;
+                int level = std::min(2, smallLod.LevelCount() - 1);
+                for (int i = 0; i < grid; i++) {
+                    for (int j = 0; j < grid; j++) {
+                        glm::mat4 stress_model = glm::mat4(1.0f);
+                        stress_model = glm::translate(stress_model, glm::vec3(-40.0f + 6.0f * i, -14.0f, -40.0f + 6.0f * j));
+                        stress_model = glm::rotate(stress_model, glm::radians(30.0f * (i + j)), glm::vec3(0.0, 1.0, 0.0));
+                        stress_model = glm::scale(stress_model, glm::vec3(0.5f));
+                        SetMat4(depthShader, "model", stress_model);
+                        smallLod.Draw(depthShader, level);
+                    }
+                }
+            }
+        };
+        // svetlece kocke (pink, mala pink, zuta, mala zuta): racunaju se jednom po frejmu, za MDI,
+        // pojedinacno crtanje i senke
+        float markerTime = (float) glfwGetTime() * 3.0f;
+        glm::mat4 markerModels[4];
+        markerModels[0] = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 11.0f + sin(markerTime) * (-2.5f), 6.0f + cos(markerTime))),
+                                     glm::vec3(0.6f));
+        markerModels[1] = glm::scale(glm::translate(markerModels[0], glm::vec3(41.0f, -5.0f, -6.0f)), glm::vec3(0.3f));
+        markerModels[2] = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 11.0f + sin(markerTime) * 2.5f, -4.0f + cos(markerTime))),
+                                     glm::vec3(0.6f));
+        markerModels[3] = glm::scale(glm::translate(markerModels[2], glm::vec3(41.0f, -5.0f, 6.0f)), glm::vec3(0.3f));
+        auto drawDynamicCasters = [&](const glm::mat4 &lightViewProjection) {
+            if (useMultiDraw) {
+                shadowBatch.Clear();
+                if (ourMultiDraw)
+                    ourGpuModel.Add(shadowBatch, model, programState->pokemonScale, ourLodLevel);
+                if (smallMultiDraw)
+                    smallGpuModel.Add(shadowBatch, model1, programState->pokemonScale * 0.5f, smallLodLevel);
+                for (unsigned int i = 0; i < 4; i++)
+                    shadowBatch.Add(cubeRange, markerModels[i], glm::vec4(1.0f), 0, i % 2 == 0 ? 0.6f : 0.18f);
+                submitShadowBatch(lightViewProjection);
+            }
+            // modeli koji se jos ucitavaju nisu u spojenom baferu
+            depthShader.use();
+            SetMat4(depthShader, "projection", lightViewProjection);
+            SetMat4(depthShader, "view", glm::mat4(1.0f));
+            if (!ourMultiDraw) {
+                SetMat4(depthShader, "model", model);
+                ourLod.Draw(depthShader, ourLodLevel);
+            }
+            if (!smallMultiDraw) {
+                SetMat4(depthShader, "model", model1);
+                smallLod.Draw(depthShader, smallLodLevel);
+            }
+            if (!useMultiDraw) {
+                glBindVertexArray(VAO_surface);
+                for (const glm::mat4 &marker : markerModels) {
+                    SetMat4(depthShader, "model", marker);
+                    glDrawArrays(GL_TRIANGLES, 0, 36);
+                }
+            }
+        };
+
+        // svetla za mdi_lit: skup 0 - plavi model, 1 - ljubicasti model i stress scena, 2 - podloge
+        // (isti parametri kao u pojedinacnim shaderima)
+        auto applyLitLights = [&]() {
+            Shader &litShader = *mdiLitShader;
+            litShader.use();
+            glm::vec3 lightDirection(0.0f, -5.0f, -15.0f);
+            glm::vec3 white(1.0f);
+            setDirLight(litShader, ourLightSet, lightDirection, glm::vec3(0.4f, 0.4f, 0.1f), glm::vec3(0.2f, 0.2f, 0.1f), white);
+            setDirLight(litShader, smallLightSet, lightDirection, glm::vec3(0.3f, 0.4f, 0.1f), glm::vec3(0.1f, 0.2f, 0.1f), white);
+            setDirLight(litShader, surfaceLightSet, lightDirection, glm::vec3(0.6f, 0.4f, 0.1f), glm::vec3(0.7f), white);
+
+            PointLight light = pointLight;
+            light.position = glm::vec3(markerModels[0][3]);
+            setPointLight(litShader, 2 * ourLightSet, light, glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 0.0, 1.0), white);
+            light.position = glm::vec3(markerModels[2][3]);
+            setPointLight(litShader, 2 * ourLightSet + 1, light, glm::vec3(0.7, 0.7, 0.0), glm::vec3(1.0, 1.0, 0.0), white);
+            light.position = glm::vec3(30.0f, 11.0f+sin(markerTime) * (-1.5f), 6.0f+cos(markerTime)*1.0f-2.0);
+            setPointLight(litShader, 2 * smallLightSet, light, glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 0.0, 1.0), white);
+            light.position = glm::vec3 (30.0f, 11.0f+sin(markerTime) * 1.5f, -4.0f+cos(markerTime)*1.0f+2.0);
+            setPointLight(litShader, 2 * smallLightSet + 1, light, glm::vec3(1.0, 1.0, 0.0), glm::vec3(1.0, 1.0, 0.0), white);
+            // podloge nemaju tackasta svetla
+            PointLight unlit;
+            unlit.position = glm::vec3(0.0f);
+            unlit.constant = 1.0f;
+            unlit.linear = 0.0f;
+            unlit.quadratic = 0.0f;
+            setPointLight(litShader, 2 * surfaceLightSet, unlit, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f));
+            setPointLight(litShader, 2 * surfaceLightSet + 1, unlit, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f));
+            SetVec3(litShader, "viewPosition", programState->camera.Position);
+
+            // spotlight
+            SetVec3(litShader, "spotLight.position", programState->camera.Position);
+            SetVec3(litShader, "spotLight.direction", programState->camera.Front);
+            SetVec3(litShader, "spotLight.ambient", 0.0f, 0.0f, 0.0f);
+            SetVec3(litShader, "spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+            SetVec3(litShader, "spotLight.specular", 1.0f, 1.0f, 1.0f);
+            SetFloat(litShader, "spotLight.constant", 1.0f);
+            SetFloat(litShader, "spotLight.linear", 0.022);
+            SetFloat(litShader, "spotLight.quadratic", 0.0019);
+            SetFloat(litShader, "spotLight.cutOff", glm::cos(glm::radians(10.0f)));
+            SetFloat(litShader, "spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
+
+            SetMat4(litShader, "projection", projection);
+            SetMat4(litShader, "view", view);
+        };
+
+        // KOCKA: SURFACE (glavni prolaz ili snimanje statickih slojeva)
+        auto drawSurfaces = [&]() {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, surface_texture);
+
+            surfaceShader.use();
+
+            // directional light
+            SetVec3(surfaceShader, "dirLight.direction", 0.0f, -5.0f, -15.0f);
+            SetVec3(surfaceShader, "dirLight.ambient", 0.6, 0.4f, 0.1f);
+            SetVec3(surfaceShader, "dirLight.diffuse", 0.7f, 0.7f, 0.7f);
+            SetVec3(surfaceShader, "dirLight.specular", 1.0f, 1.0f, 1.0f);
+            SetVec3(surfaceShader, "viewPosition", programState->camera.Position);
+            SetFloat(surfaceShader, "material.shininess", 126.0f);
+
+            // spotlight
+            SetVec3(surfaceShader, "spotLight.position", programState->camera.Position);
+            SetVec3(surfaceShader, "spotLight.direction", programState->camera.Front);
+            SetVec3(surfaceShader, "spotLight.ambient", 0.0f, 0.0f, 0.0f);
+            SetVec3(surfaceShader, "spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+            SetVec3(surfaceShader, "spotLight.specular", 1.0f, 1.0f, 1.0f);
+            SetFloat(surfaceShader, "spotLight.constant", 1.0f);
+            SetFloat(surfaceShader, "spotLight.linear", 0.022);
+            SetFloat(surfaceShader, "spotLight.quadratic", 0.0019);
+            SetFloat(surfaceShader, "spotLight.cutOff", glm::cos(glm::radians(10.0f)));
+            SetFloat(surfaceShader, "spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
+
+            // matrice transformacija: view, projection
+            SetMat4(surfaceShader, "projection", projection);
+            SetMat4(surfaceShader, "view", view);
+
+            // model matrica i render kocke za plavi model
+            SetMat4(surfaceShader, "model", surface_model);
+
+            glBindVertexArray(VAO_surface);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+
+            // model matrica i render kocke za ljubicasti model
+            SetMat4(surfaceShader, "model", small_surface_model);
+            glBindVertexArray(VAO_surface);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        };
+
+        // SKYBOX: bez translacije iz matrice pogleda, na dubini 1.0 (GL_LEQUAL)
+        auto drawSkybox = [&]() {
+            glDepthFunc(GL_LEQUAL);
+
+            skyboxShader.use();
+            SetMat4(skyboxShader, "view", glm::mat4(glm::mat3(view)));
+            SetMat4(skyboxShader, "projection", projection);
+
+            glBindVertexArray(skyboxVAO);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glBindVertexArray(0);
+            glDepthFunc(GL_LESS);
+        };
+
+        prepareZone.End();
 
         // render
         // ------------------------------------------------------------------------------------------------------------------------
+        frameTimer.Begin();
+        GLint windowViewport[4];
+        glGetIntegerv(GL_VIEWPORT, windowViewport);
+
+        if (shadows) {
+            TracePass pass(gpuTrace, "Shadow maps");
+            shadowMaps.Render(programState->ShadowCacheEnabled, drawStaticCasters, drawDynamicCasters);
+            glViewport(windowViewport[0], windowViewport[1], windowViewport[2], windowViewport[3]);
+        }
+
         glClearColor(programState->clearColor.r, programState->clearColor.g, programState->clearColor.b, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        // staticki slojevi se snimaju kad se pogled smiri, a dok se ne promeni samo kopiraju (boja + dubina)
+        if (staticCached) {
+            TracePass pass(gpuTrace, "Static layers");
+            if (!staticLayers.Matches(staticSignature)) {
+                staticLayers.BeginCapture(programState->clearColor);
+                if (useMultiDraw) {
+                    applyIbl(*mdiLitShader);
+                    applyLitLights();
+                    staticBatch.Clear();
+                    staticBatch.Add(cubeRange, surface_model, glm::vec4(1.0f), surfaceMaterial, 8.0f);
+                    staticBatch.Add(cubeRange, small_surface_model, glm::vec4(1.0f), surfaceMaterial, 4.0f);
+                    staticBatch.Submit(gpuScene, *mdiLitShader, viewFrustum, false, mdiCullProgram, true);
+                } else {
+                    applyIbl(surfaceShader);
+                    drawSurfaces();
+                }
+                drawSkybox();
+                staticLayers.EndCapture(staticSignature);
+            }
+            staticLayers.Composite(hdrFBO);
+        }
+        TraceCounter("Static layers cached", staticCached ? 1.0f : 0.0f);
+
+        // 3D prolazi crtaju u donji levi deo hdrFBO u internoj rezoluciji
+        glViewport(0, 0, renderSize.x, renderSize.y);
+
+        // ------------------------------------------------------------------------------------------------------------------------
+        // DEPTH PRE-PASS: samo dubina neprozirnih objekata; glavni prolaz (GL_LEQUAL) onda senci svaki piksel jednom
+        // ------------------------------------------------------------------------------------------------------------------------
+
+        bool depthPrepass = programState->DepthPrepassEnabled;
+        if (depthPrepass) {
+            TracePass pass(gpuTrace, "Depth pre-pass");
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            // shaderi scene nisu invariant u odnosu na depth_prepass.vs, pa dubina moze da se razlikuje u
+            // poslednjem bitu; pre-pass se gura za najmanji korak unazad, a glavni prolaz koristi GL_LEQUAL
+            glEnable(GL_POLYGON_OFFSET_FILL);
+            glPolygonOffset(1.0f, 1.0f);
+
+            depthShader.use();
+            SetMat4(depthShader, "projection", projection);
+            SetMat4(depthShader, "view", view);
+            if (ourVisible && !ourMultiDraw) {
+                SetMat4(depthShader, "model", model);
+                ourLod.Draw(depthShader, ourLodLevel);
+            }
+            if (smallVisible && !smallMultiDraw) {
+                SetMat4(depthShader, "model", model1);
+                smallLod.Draw(depthShader, smallLodLevel);
+            }
+            for (const DrawPacket &packet : packets) {
+                SetMat4(depthShader, "model", packet.model);
+                smallLod.Draw(depthShader, *packet.lodLevel);
+            }
+            if (!staticCached && !useMultiDraw) {
+                glBindVertexArray(VAO_surface);
+                SetMat4(depthShader, "model", surface_model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                SetMat4(depthShader, "model", small_surface_model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+
+            // MDI komande se salju ovde, a glavni prolaz ih samo ponovo crta
+            if (useMultiDraw) {
+                mdiDepthShader->use();
+                SetMat4(*mdiDepthShader, "projection", projection);
+                SetMat4(*mdiDepthShader, "view", view);
+                opaqueBatch.Submit(gpuScene, *mdiDepthShader, viewFrustum, programState->GpuCullingEnabled,
+                                   mdiCullProgram, false);
+            }
+
+            glDisable(GL_POLYGON_OFFSET_FILL);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthFunc(GL_LEQUAL);
+            glDepthMask(GL_FALSE);
+        }
+
+        // broj fragmenata koji prodju test dubine u neprozirnom prolazu (overdraw)
+        TracePass opaquePass(gpuTrace, "Opaque");
+        applyIbl(ourShader);
+        applyIbl(smallShader);
+        applyIbl(surfaceShader);
+        if (mdiLitShader)
+            applyIbl(*mdiLitShader);
+        overdrawCounter.Begin();
 
         // ------------------------------------------------------------------------------------------------------------------------
         // PLAVI MODEL
@@ -479,59 +1504,48 @@ int main() {
         ourShader.use();
 
         // point light (0 - pink, 1 - yellow)
-        pointLight.position = glm::vec3(5.0f, 11.0f+sin(glfwGetTime()*3.0f) * (-2.5f), 6.0f+cos(glfwGetTime()*3.0f)*1.0f);
-        ourShader.setVec3("pointLight[0].position", pointLight.position);
-        ourShader.setVec3("pointLight[0].ambient", 1.0, 0.0, 1.0);
-        ourShader.setVec3("pointLight[0].diffuse", 1.0, 0.0, 1.0);
-        ourShader.setVec3("pointLight[0].specular", 1.0, 1.0, 1.0);
-        ourShader.setFloat("pointLight[0].constant", pointLight.constant);
-        ourShader.setFloat("pointLight[0].linear", pointLight.linear);
-        ourShader.setFloat("pointLight[0].quadratic", pointLight.quadratic);
-        ourShader.setVec3("viewPosition", programState->camera.Position);
-        ourShader.setFloat("material.shininess", 256.0f);
-
-        pointLight.position = glm::vec3 (5.0f, 11.0f+sin(glfwGetTime()*3.0f) * 2.5f, -4.0f+cos(glfwGetTime()*3.0f)*1.0f);
-        ourShader.setVec3("pointLight[1].position", pointLight.position);
-        ourShader.setVec3("pointLight[1].ambient", 0.7, 0.7, 0.0);
-        ourShader.setVec3("pointLight[1].diffuse", 1.0, 1.0, 0.0);
-        ourShader.setVec3("pointLight[1].specular", 1.0, 1.0, 1.0);
-        ourShader.setFloat("pointLight[1].constant", pointLight.constant);
-        ourShader.setFloat("pointLight[1].linear", pointLight.linear);
-        ourShader.setFloat("pointLight[1].quadratic", pointLight.quadratic);
+        pointLight.position = glm::vec3(markerModels[0][3]);
+        setPointLight(ourShader, 0, pointLight, glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 1.0, 1.0));
+        SetVec3(ourShader, "viewPosition", programState->camera.Position);
+        SetFloat(ourShader, "material.shininess", 256.0f);
+
+        pointLight.position = glm::vec3(markerModels[2][3]);
+        setPointLight(ourShader, 1, pointLight, glm::vec3(0.7, 0.7, 0.0), glm::vec3(1.0, 1.0, 0.0), glm::vec3(1.0, 1.0, 1.0));
 
         // directional light
-        ourShader.setVec3("dirLight.direction", 0.0f, -5.0f, -15.0f);
-        ourShader.setVec3("dirLight.ambient", 0.4f, 0.4f, 0.1f);
-        ourShader.setVec3("dirLight.diffuse", 0.2f, 0.2f, 0.1f);
-        ourShader.setVec3("dirLight.specular", 1.0f, 1.0f, 1.0f);
+        SetVec3(ourShader, "dirLight.direction", 0.0f, -5.0f, -15.0f);
+        SetVec3(ourShader, "dirLight.ambient", 0.4f, 0.4f, 0.1f);
+        SetVec3(ourShader, "dirLight.diffuse", 0.2f, 0.2f, 0.1f);
+        SetVec3(ourShader, "dirLight.specular", 1.0f, 1.0f, 1.0f);
 
         // spotlight
-        ourShader.setVec3("spotLight.position", programState->camera.Position);
-        ourShader.setVec3("spotLight.direction", programState->camera.Front);
-        ourShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-        ourShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-        ourShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-        ourShader.setFloat("spotLight.constant", 1.0f);
-        ourShader.setFloat("spotLight.linear", 0.022);
-        ourShader.setFloat("spotLight.quadratic", 0.0019);
-        ourShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(10.0f)));
-        ourShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
+        SetVec3(ourShader, "spotLight.position", programState->camera.Position);
+        SetVec3(ourShader, "spotLight.direction", programState->camera.Front);
+        SetVec3(ourShader, "spotLight.ambient", 0.0f, 0.0f, 0.0f);
+        SetVec3(ourShader, "spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+        SetVec3(ourShader, "spotLight.specular", 1.0f, 1.0f, 1.0f);
+        SetFloat(ourShader, "spotLight.constant", 1.0f);
+        SetFloat(ourShader, "spotLight.linear", 0.022);
+        SetFloat(ourShader, "spotLight.quadratic", 0.0019);
+        SetFloat(ourShader, "spotLight.cutOff", glm::cos(glm::radians(10.0f)));
+        SetFloat(ourShader, "spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
 
         // matrice transformacija: view, projection
-        glm::mat4 projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                                (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.3f, 500.0f);
-        glm::mat4 view = programState->camera.GetViewMatrix();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
+        SetMat4(ourShader, "projection", projection);
+        SetMat4(ourShader, "view", view);
 
-        // model matrica i render
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model,programState->pokemonPosition);
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0, 1.0, 0.0));
-        model = glm::scale(model, glm::vec3(programState->pokemonScale));
-        ourShader.setMat4("model", model);
+        placeholderShader.use();
+        SetMat4(placeholderShader, "projection", projection);
+        SetMat4(placeholderShader, "view", view);
+        ourShader.use();
 
-        ourModel.Draw(ourShader);
+        // model matrica i render
+        SetMat4(ourShader, "model", model);
+        if (ourVisible) {
+            if (!ourMultiDraw)
+                ourLod.Draw(ourShader, ourLodLevel);
+            lodStats.Count(ourLod, ourLodLevel);
+        }
 
 
         // ------------------------------------------------------------------------------------------------------------------------
@@ -541,225 +1555,284 @@ int main() {
         smallShader.use();
 
         // point light (0 - pink, 1 - yellow)
-        pointLight.position = glm::vec3(30.0f, 11.0f+sin(glfwGetTime()*3.0f) * (-1.5f), 6.0f+cos(glfwGetTime()*3.0f)*1.0f-2.0);
-        smallShader.setVec3("pointLight[0].position", pointLight.position);
-        smallShader.setVec3("pointLight[0].ambient", 1.0, 0.0, 1.0);
-        smallShader.setVec3("pointLight[0].diffuse", 1.0, 0.0, 1.0);
-        smallShader.setVec3("pointLight[0].specular", 1.0, 1.0, 1.0);
-        smallShader.setFloat("pointLight[0].constant", pointLight.constant);
-        smallShader.setFloat("pointLight[0].linear", pointLight.linear);
-        smallShader.setFloat("pointLight[0].quadratic", pointLight.quadratic);
-        smallShader.setVec3("viewPosition", programState->camera.Position);
-        smallShader.setFloat("material.shininess", 256.0f);
-
-        pointLight.position = glm::vec3 (30.0f, 11.0f+sin(glfwGetTime()*3.0f) * 1.5f, -4.0f+cos(glfwGetTime()*3.0f)*1.0f+2.0);
-        smallShader.setVec3("pointLight[1].position", pointLight.position);
-        smallShader.setVec3("pointLight[1].ambient", 1.0, 1.0, 0.0);
-        smallShader.setVec3("pointLight[1].diffuse", 1.0, 1.0, 0.0);
-        smallShader.setVec3("pointLight[1].specular", 1.0, 1.0, 1.0);
-        smallShader.setFloat("pointLight[1].constant", pointLight.constant);
-        smallShader.setFloat("pointLight[1].linear", pointLight.linear);
-        smallShader.setFloat("pointLight[1].quadratic", pointLight.quadratic);
+        pointLight.position = glm::vec3(30.0f, 11.0f+sin(markerTime) * (-1.5f), 6.0f+cos(markerTime)*1.0f-2.0);
+        setPointLight(smallShader, 0, pointLight, glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 1.0, 1.0));
+        SetVec3(smallShader, "viewPosition", programState->camera.Position);
+        SetFloat(smallShader, "material.shininess", 256.0f);
+
+        pointLight.position = glm::vec3 (30.0f, 11.0f+sin(markerTime) * 1.5f, -4.0f+cos(markerTime)*1.0f+2.0);
+        setPointLight(smallShader, 1, pointLight, glm::vec3(1.0, 1.0, 0.0), glm::vec3(1.0, 1.0, 0.0), glm::vec3(1.0, 1.0, 1.0));
 
         // directional light
-        smallShader.setVec3("dirLight.direction", 0.0f, -5.0f, -15.0f);
-        smallShader.setVec3("dirLight.ambient", 0.3f, 0.4f, 0.1f);
-        smallShader.setVec3("dirLight.diffuse", 0.1f, 0.2f, 0.1f);
-        smallShader.setVec3("dirLight.specular", 1.0f, 1.0f, 1.0f);
+        SetVec3(smallShader, "dirLight.direction", 0.0f, -5.0f, -15.0f);
+        SetVec3(smallShader, "dirLight.ambient", 0.3f, 0.4f, 0.1f);
+        SetVec3(smallShader, "dirLight.diffuse", 0.1f, 0.2f, 0.1f);
+        SetVec3(smallShader, "dirLight.specular", 1.0f, 1.0f, 1.0f);
 
         // spotlight
-        smallShader.setVec3("spotLight.position", programState->camera.Position);
-        smallShader.setVec3("spotLight.direction", programState->camera.Front);
-        smallShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-        smallShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-        smallShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-        smallShader.setFloat("spotLight.constant", 1.0f);
-        smallShader.setFloat("spotLight.linear", 0.022);
-        smallShader.setFloat("spotLight.quadratic", 0.0019);
-        smallShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(10.0f)));
-        smallShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
+        SetVec3(smallShader, "spotLight.position", programState->camera.Position);
+        SetVec3(smallShader, "spotLight.direction", programState->camera.Front);
+        SetVec3(smallShader, "spotLight.ambient", 0.0f, 0.0f, 0.0f);
+        SetVec3(smallShader, "spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+        SetVec3(smallShader, "spotLight.specular", 1.0f, 1.0f, 1.0f);
+        SetFloat(smallShader, "spotLight.constant", 1.0f);
+        SetFloat(smallShader, "spotLight.linear", 0.022);
+        SetFloat(smallShader, "spotLight.quadratic", 0.0019);
+        SetFloat(smallShader, "spotLight.cutOff", glm::cos(glm::radians(10.0f)));
+        SetFloat(smallShader, "spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
 
         // matrice transformacija: view, projection
-        smallShader.setMat4("projection", projection);
-        smallShader.setMat4("view", view);
+        SetMat4(smallShader, "projection", projection);
+        SetMat4(smallShader, "view", view);
 
         // model matrica i render
-        glm::mat4 model1 = glm::mat4(1.0f);
-        model1 = glm::translate(model1,programState->pokemonPosition);
-        model1 = glm::translate(model1, glm::vec3(30.0, 0.0, 0.0));
-        model1 = glm::rotate(model1, glm::radians(270.0f), glm::vec3(0.0, 1.0, 0.0));
-        model1 = glm::scale(model1, glm::vec3(programState->pokemonScale));
-        model1 = glm::scale(model1, glm::vec3(0.5, 0.5, 0.5));
-        smallShader.setMat4("model", model1);
+        SetMat4(smallShader, "model", model1);
+        if (smallVisible) {
+            if (!smallMultiDraw)
+                smallLod.Draw(smallShader, smallLodLevel);
+            lodStats.Count(smallLod, smallLodLevel);
+        }
 
-        smallModel.Draw(smallShader);
+        // ------------------------------------------------------------------------------------------------------------------------
+        // MDI: MODELI, PODLOGE I STRESS SCENA
+        // ------------------------------------------------------------------------------------------------------------------------
+
+        if (useMultiDraw) {
+            // LOD se bira na CPU, a crta se sa po jednim glMultiDrawElementsIndirect pozivom po grupi stranica;
+            // sjaj i skup svetala dolaze iz materijala
+            applyLitLights();
+            if (depthPrepass)
+                opaqueBatch.Draw(gpuScene, *mdiLitShader, true);
+            else
+                opaqueBatch.Submit(gpuScene, *mdiLitShader, viewFrustum, programState->GpuCullingEnabled, mdiCullProgram, true);
+            multiDrawState.opaque = opaqueBatch.stats;
+        }
+        if (stressActive && !stressMultiDraw) {
+            smallShader.use();
+            for (const DrawPacket &packet : packets) {
+                SetMat4(smallShader, "model", packet.model);
+                smallLod.Draw(smallShader, *packet.lodLevel);
+            }
+        }
 
         // ------------------------------------------------------------------------------------------------------------------------
         // KOCKA: SURFACE
         // ------------------------------------------------------------------------------------------------------------------------
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, surface_texture);
+        if (!staticCached && !useMultiDraw)
+            drawSurfaces();
 
-        surfaceShader.use();
+        overdrawCounter.End();
+        occlusionStats.fragmentsShaded = overdrawCounter.Result();
+        if (depthPrepass) {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+        }
 
-        // directional light
-        surfaceShader.setVec3("dirLight.direction", 0.0f, -5.0f, -15.0f);
-        surfaceShader.setVec3("dirLight.ambient", 0.6, 0.4f, 0.1f);
-        surfaceShader.setVec3("dirLight.diffuse", 0.7f, 0.7f, 0.7f);
-        surfaceShader.setVec3("dirLight.specular", 1.0f, 1.0f, 1.0f);
-        surfaceShader.setVec3("viewPosition", programState->camera.Position);
-        surfaceShader.setFloat("material.shininess", 126.0f);
+        // placeholderi modela koji se jos ucitavaju (nisu u depth pre-passu)
+        assetManager->DrawPlaceholder(ourModel, placeholderShader, model);
+        assetManager->DrawPlaceholder(smallModel, placeholderShader, model1);
+
+        // svetlece kocke upisuju emissiveStencil, da ih razresavanje senki ne bi zatamnilo
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_ALWAYS, emissiveStencil, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+
+        if (useMultiDraw) {
+            // ------------------------------------------------------------------------------------------------------------------------
+            // KOCKE: PINK I YELLOW LIGHT (jedan MDI poziv za sve svetlece kocke)
+            // ------------------------------------------------------------------------------------------------------------------------
+
+            glm::vec4 pinkColor(1.0f, 0.0f, 1.0f, 1.0f);
+            glm::vec4 yellowColor(1.0f, 1.0f, 0.0f, 1.0f);
+            emissiveBatch.Clear();
+
+            emissiveBatch.Add(cubeRange, markerModels[0], pinkColor, 0, 0.6f);
+            emissiveBatch.Add(cubeRange, markerModels[1], pinkColor, 0, 0.18f);
+            emissiveBatch.Add(cubeRange, markerModels[2], yellowColor, 0, 0.6f);
+            emissiveBatch.Add(cubeRange, markerModels[3], yellowColor, 0, 0.18f);
+
+            for (unsigned int i = 0; i < 10; i++) {
+                glm::mat4 cube_model = glm::mat4(1.0f);
+                cube_model = glm::translate(cube_model, cubePositions[i]);
+                cube_model = glm::scale(cube_model, glm::vec3(0.3, 0.3, 0.3));
+                emissiveBatch.Add(cubeRange, cube_model, yellowColor, 0, 0.3f);
+            }
+
+            mdiEmissiveShader->use();
+            SetMat4(*mdiEmissiveShader, "projection", projection);
+            SetMat4(*mdiEmissiveShader, "view", view);
+            emissiveBatch.Submit(gpuScene, *mdiEmissiveShader, Frustum(projection * view), programState->GpuCullingEnabled,
+                                 mdiCullProgram, false);
+            multiDrawState.emissive = emissiveBatch.stats;
+        } else {
+            // ------------------------------------------------------------------------------------------------------------------------
+            // KOCKA: PINK LIGHT
+            // ------------------------------------------------------------------------------------------------------------------------
 
-        // spotlight
-        surfaceShader.setVec3("spotLight.position", programState->camera.Position);
-        surfaceShader.setVec3("spotLight.direction", programState->camera.Front);
-        surfaceShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-        surfaceShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-        surfaceShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-        surfaceShader.setFloat("spotLight.constant", 1.0f);
-        surfaceShader.setFloat("spotLight.linear", 0.022);
-        surfaceShader.setFloat("spotLight.quadratic", 0.0019);
-        surfaceShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(10.0f)));
-        surfaceShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
+            pinkShader.use();
 
-        // matrice transformacija: view, projection
-        surfaceShader.setMat4("projection", projection);
-        surfaceShader.setMat4("view", view);
+            // matrice transformacija: view, projection
+            SetMat4(pinkShader, "projection", projection);
+            SetMat4(pinkShader, "view", view);
 
-        // model matrica i render kocke za plavi model
-        glm::mat4 surface_model = glm::mat4(1.0f);
-        surface_model = glm::translate(surface_model, glm::vec3(1.0f, -0.9f, 1.5f));
-        surface_model = glm::scale(surface_model, glm::vec3(8.0, 4.0, 8.0));
-        surfaceShader.setMat4("model", surface_model);
+            // model matrica i render kocke za plavi model
+            SetMat4(pinkShader, "model", markerModels[0]);
 
-        glBindVertexArray(VAO_surface);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+            glBindVertexArray(VAO_surface);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        // model matrica i render kocke za ljubicasti model
-        surface_model = glm::translate(surface_model, glm::vec3(3.72f, 0.25f, -0.07f));
-        surface_model = glm::scale(surface_model, glm::vec3(0.5, 0.5, 0.5));
-        surfaceShader.setMat4("model", surface_model);
-        glBindVertexArray(VAO_surface);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+            // model matrica i render kocke za ljubicasti model
+            SetMat4(yellowShader, "model", markerModels[1]);
+            glBindVertexArray(VAO_surface);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        // ------------------------------------------------------------------------------------------------------------------------
-        // KOCKA: PINK LIGHT
-        // ------------------------------------------------------------------------------------------------------------------------
+            // ------------------------------------------------------------------------------------------------------------------------
+            // KOCKA: YELLOW LIGHT
+            // ------------------------------------------------------------------------------------------------------------------------
 
-        pinkShader.use();
+            yellowShader.use();
 
-        // matrice transformacija: view, projection
-        pinkShader.setMat4("projection", projection);
-        pinkShader.setMat4("view", view);
+            // matrice transformacija: view, projection
+            SetMat4(yellowShader, "projection", projection);
+            SetMat4(yellowShader, "view", view);
 
-        // model matrica i render kocke za plavi model
-        glm::mat4 pink_model = glm::mat4(1.0f);
-        pink_model = glm::translate(pink_model, glm::vec3(5.0f, 11.0f+sin(glfwGetTime()*3.0f) * (-2.5f), 6.0f+cos(glfwGetTime()*3.0f)*1.0f));
-        pink_model = glm::scale(pink_model, glm::vec3(0.6, 0.6, 0.6));
-        pinkShader.setMat4("model", pink_model);
+            // model matrica i render kocke za plavi model
+            SetMat4(yellowShader, "model", markerModels[2]);
 
-        glBindVertexArray(VAO_surface);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+            glBindVertexArray(VAO_surface);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        // model matrica i render kocke za ljubicasti model
-        pink_model = glm::translate(pink_model, glm::vec3(41.0f, -5.0, -6.0));
-        pink_model = glm::scale(pink_model, glm::vec3(0.3, 0.3, 0.3));
-        yellowShader.setMat4("model", pink_model);
-        glBindVertexArray(VAO_surface);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+            // model matrica i render kocke za ljubicasti model
+            SetMat4(yellowShader, "model", markerModels[3]);
+            glBindVertexArray(VAO_surface);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        // ------------------------------------------------------------------------------------------------------------------------
-        // KOCKA: YELLOW LIGHT
-        // ------------------------------------------------------------------------------------------------------------------------
+            // ------------------------------------------------------------------------------------------------------------------------
+            // KOCKA: YELLOW LIGHT po sceni
+            // ------------------------------------------------------------------------------------------------------------------------
 
-        yellowShader.use();
+            for (unsigned int i = 0; i < 10; i++)
+            {
+                glm::mat4 yellow_model = glm::mat4(1.0f);
+                yellow_model = glm::translate(yellow_model, cubePositions[i]);
+                yellow_model = glm::scale(yellow_model, glm::vec3(0.3, 0.3, 0.3));
+                float angle = 20.0f * i;
+                model = glm::rotate(yellow_model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+                SetMat4(yellowShader, "model", yellow_model);
+
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+        glDisable(GL_STENCIL_TEST);
 
-        // matrice transformacija: view, projection
-        yellowShader.setMat4("projection", projection);
-        yellowShader.setMat4("view", view);
+        opaquePass.End();
 
-        // model matrica i render kocke za plavi model
-        glm::mat4 yellow_model = glm::mat4(1.0f);
-        yellow_model = glm::translate(yellow_model, glm::vec3(5.0f, 11.0f+sin(glfwGetTime()*3.0f) * 2.5f, -4.0f+cos(glfwGetTime()*3.0f)*1.0f));
-        yellow_model = glm::scale(yellow_model, glm::vec3(0.6, 0.6, 0.6));
-        yellowShader.setMat4("model", yellow_model);
+        if (programState->HiZCullingEnabled || shadows || temporal) {
+            TracePass pass(gpuTrace, "Scene depth copy");
+            sceneDepth.Copy(hdrFBO, renderSize.x, renderSize.y);
+        }
 
-        glBindVertexArray(VAO_surface);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        // Hi-Z piramida od dubine neprozirnog dela scene (pre providnih oblaka), koristi se narednih frejmova
+        if (programState->HiZCullingEnabled) {
+            TracePass pass(gpuTrace, "Hi-Z build");
+            hiZ.Build(hdrFBO, sceneDepth.Texture(), hizShader, projection * view, renderSize.x, renderSize.y);
+        } else {
+            hiZ.Invalidate();
+        }
 
-        // model matrica i render kocke za ljubicasti model
-        yellow_model = glm::translate(yellow_model, glm::vec3(41.0f, -5.0, 6.0));
-        yellow_model = glm::scale(yellow_model, glm::vec3(0.3, 0.3, 0.3));
-        yellowShader.setMat4("model", yellow_model);
-        glBindVertexArray(VAO_surface);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        // senke se nanose na neprozirni deo scene (pre oblaka i skybox-a)
+        if (shadows) {
+            TracePass pass(gpuTrace, "Shadow resolve");
+            shadowMaps.Resolve(hdrFBO, sceneDepth.Texture(), renderSize.x, renderSize.y, shadowResolveShader, projection * view,
+                               programState->camera.Position, programState->ShadowStrength, emissiveStencil);
+        }
+        TracePass transparentPass(gpuTrace, "Clouds + skybox");
 
         // ------------------------------------------------------------------------------------------------------------------------
-        // KOCKA: YELLOW LIGHT po sceni
+        // SKYBOX
         // ------------------------------------------------------------------------------------------------------------------------
 
-        for (unsigned int i = 0; i < 10; i++)
-        {
-            glm::mat4 yellow_model = glm::mat4(1.0f);
-            yellow_model = glm::translate(yellow_model, cubePositions[i]);
-            yellow_model = glm::scale(yellow_model, glm::vec3(0.3, 0.3, 0.3));
-            float angle = 20.0f * i;
-            model = glm::rotate(yellow_model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            yellowShader.setMat4("model", yellow_model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-
+        // pre oblaka, da se oni uvek mesaju sa nebom; sa kesom je skybox vec u kompozitu statickih slojeva
+        if (!staticCached)
+            drawSkybox();
 
         // ------------------------------------------------------------------------------------------------------------------------
         // OBLAK
         // ------------------------------------------------------------------------------------------------------------------------
 
-        cloudShader.use();
-
-        cloudShader.setMat4("projection", projection);
-        cloudShader.setMat4("view", view);
-        glm::mat4 cloud_model = glm::mat4(1.0f);
-        glBindVertexArray(transparentVAO);
-        glBindTexture(GL_TEXTURE_2D, transparentTexture);
-
         // disable face culling kako bi se renderovale obe strane
         glDisable(GL_CULL_FACE);
-        for (unsigned int i = 0; i < cloud_positions.size(); i++)
-        {
-            cloud_model = glm::mat4(1.0f);
-            cloud_model = glm::translate(cloud_model, cloud_positions[i]);
-            cloud_model = glm::scale(cloud_model, glm::vec3(7.0+i,  7.0+i, 7.0+i));
-            cloudShader.setMat4("model", cloud_model);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+        if (useMultiDraw) {
+            // redosled crtanja ostaje redosled dodavanja (jedna grupa stranica, bez sortiranja)
+            cloudBatch.Clear();
+            for (unsigned int i = 0; i < cloud_positions.size(); i++) {
+                glm::mat4 cloud_model = glm::translate(glm::mat4(1.0f), cloud_positions[i]);
+                cloud_model = glm::scale(cloud_model, glm::vec3(7.0+i,  7.0+i, 7.0+i));
+                cloudBatch.Add(cloudRange, cloud_model, glm::vec4(1.0f), cloudMaterial, 7.0f + i);
+            }
+            mdiCloudShader->use();
+            SetMat4(*mdiCloudShader, "projection", projection);
+            SetMat4(*mdiCloudShader, "view", view);
+            cloudBatch.Submit(gpuScene, *mdiCloudShader, viewFrustum, false, mdiCullProgram, true);
+            multiDrawState.clouds = cloudBatch.stats;
+        } else {
+            cloudShader.use();
+
+            SetMat4(cloudShader, "projection", projection);
+            SetMat4(cloudShader, "view", view);
+            glm::mat4 cloud_model = glm::mat4(1.0f);
+            glBindVertexArray(transparentVAO);
+            glBindTexture(GL_TEXTURE_2D, transparentTexture);
+
+            for (unsigned int i = 0; i < cloud_positions.size(); i++)
+            {
+                cloud_model = glm::mat4(1.0f);
+                cloud_model = glm::translate(cloud_model, cloud_positions[i]);
+                cloud_model = glm::scale(cloud_model, glm::vec3(7.0+i,  7.0+i, 7.0+i));
+                SetMat4(cloudShader, "model", cloud_model);
+                glDrawArrays(GL_TRIANGLES, 0, 6);
+            }
         }
         glEnable(GL_CULL_FACE);
 
 
         // ------------------------------------------------------------------------------------------------------------------------
-        // SKYBOX
+        // CESTICE NAPADA (posle skybox-a, jer ne upisuju dubinu)
         // ------------------------------------------------------------------------------------------------------------------------
 
-        glDepthFunc(GL_LEQUAL);
+        if (particles.Alive() > 0) {
+            TracePass pass(gpuTrace, "Particles");
+            particleTimer.Begin();
+            particleRenderer.Draw(particleShader, projection, view, programState->ParticleIntensity);
+            particleTimer.End();
+            particles.stats.drawMs = particleTimer.Milliseconds();
+        }
+        transparentPass.End();
 
-        skyboxShader.use();
-        // matrice transformacije: view, projection ( + uklanjanje translacije iz matrice pogleda)
-        view = glm::mat4(glm::mat3(programState->camera.GetViewMatrix()));
-        skyboxShader.setMat4("view", view);
-        skyboxShader.setMat4("projection", projection);
+        // ------------------------------------------------------------------------------------------------------------------------
+        // TEMPORAL UPSCALING: interna rezolucija + istorija -> puna rezolucija (pre bloom-a)
+        // ------------------------------------------------------------------------------------------------------------------------
 
-        glBindVertexArray(skyboxVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-        glDepthFunc(GL_LESS);
+        unsigned int sceneColor = colorBuffers[0];
+        unsigned int brightColor = colorBuffers[1];
+        if (temporal) {
+            TracePass pass(gpuTrace, "Temporal resolve");
+            upscaler.Resolve(sceneDepth.Texture(), taaShader, colorBuffers[0], colorBuffers[1], unjitteredViewProjection, renderQuad);
+            sceneColor = upscaler.Output();
+            brightColor = upscaler.Bright();
+        } else {
+            upscaler.Reset();
+        }
+        // blur radi u punoj velicini ciljeva scene, a zavrsna slika u prozoru (ili u polju atlasa)
+        glViewport(0, 0, frameWidth, frameHeight);
 
         // ------------------------------------------------------------------------------------------------------------------------
         // HDR & BLOOM
         // ------------------------------------------------------------------------------------------------------------------------
 
+        TracePass bloomPass(gpuTrace, "Bloom + tonemap");
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
         bool horizontal = true, first_iteration = true;
@@ -771,66 +1844,85 @@ int main() {
         for (unsigned int i = 0; i < amount; i++)
         {
             glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
-            shaderBlur.setInt("horizontal", horizontal);
-            glBindTexture(GL_TEXTURE_2D, first_iteration ? colorBuffers[1] : pingpongColorbuffers[!horizontal]);
+            SetInt(shaderBlur, "horizontal", horizontal);
+            glBindTexture(GL_TEXTURE_2D, first_iteration ? brightColor : pingpongColorbuffers[!horizontal]);
             renderQuad();
             horizontal = !horizontal;
             if (first_iteration)
                 first_iteration = false;
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-        // renderovanje floating point color buffera, tonemap HDR boja
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // renderovanje floating point color buffera, tonemap HDR boja (u paketnom rezimu u polje atlasa)
+        if (batchRenderer) {
+            batchRenderer->BindTarget();
+        } else {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(windowViewport[0], windowViewport[1], windowViewport[2], windowViewport[3]);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
         shaderBloomFinal.use();
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
+        glBindTexture(GL_TEXTURE_2D, sceneColor);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]);
-        shaderBloomFinal.setInt("bloom", bloom);
-        shaderBloomFinal.setFloat("exposure", exposure);
+        SetInt(shaderBloomFinal, "bloom", bloom);
+        SetFloat(shaderBloomFinal, "exposure", exposure);
         renderQuad();
+        bloomPass.End();
+        frameTimer.End();
+
+        if (batchRenderer) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(windowViewport[0], windowViewport[1], windowViewport[2], windowViewport[3]);
+            bool ready = assetManager->IsSettled(ourModel) && assetManager->IsSettled(smallModel) && !streamer.Busy();
+            batchRenderer->EndFrame(ready);
+            if (batchRenderer->Done())
+                glfwSetWindowShouldClose(window, true);
+        }
 
         //glBindVertexArray(0);
 
         // ImGui
-        if (programState->ImGuiEnabled)
+        if (programState->ImGuiEnabled) {
+            TracePass pass(gpuTrace, "ImGui");
             DrawImGui(programState);
+        }
+
 
 
+        frameMemoryStats.Push(HeapAllocationCount() - frameAllocationsStart, ThreadFrameArena().Used());
 
         // glfw: swap buffers & poll IO events
+        TraceZone swapZone("Swap buffers");
         glfwSwapBuffers(window);
-        glfwPollEvents();
+        framePacer.EndFrame();
+        swapZone.End();
+
+        // proredjivanje: do isteka intervala 1/IdleFps se samo ceka na dogadjaje;
+        // u low latency rezimu se dogadjaji citaju na pocetku sledeceg frejma
+        double idleWait = 1.0 / programState->IdleFps - (glfwGetTime() - currentFrame);
+        if (idle && idleMode == IdleMode::Throttle && idleWait > 0.0)
+            glfwWaitEventsTimeout(idleWait);
+        else if (!programState->LowLatencyEnabled)
+            glfwPollEvents();
+        if (!programState->LowLatencyEnabled)
+            framePacer.MarkInput();
     }
-    programState->SaveToFile("resources/program_state.txt");
+    if (batchRenderer)
+        batchRenderer->Finish();
+    Tracer::Get().Stop();
+    if (!batchMode)
+        programState->SaveToFile("resources/program_state.txt");
     delete programState;
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
     // glfw: deaktiviranje i ciscenje:
+    // lokalni GL resursi se oslobadjaju sami (RAII), ContextGuard zatim prijavljuje curenja i gasi glfw
+    delete assetManager;
+    releaseQuad();
 
-    glDeleteVertexArrays(1, &VAO_surface);
-    glDeleteVertexArrays(1, &planeVAO);
-    glDeleteVertexArrays(1, &transparentVAO);
-    glDeleteVertexArrays(1, &skyboxVAO);
-
-    glDeleteBuffers(1, &VBO_surface);
-    glDeleteBuffers(1, &planeVBO);
-    glDeleteBuffers(1, &transparentVBO);
-    glDeleteBuffers(1, &skyboxVBO);
-
-    glDeleteFramebuffers(1, &hdrFBO);
-    glDeleteFramebuffers(1, &pingpongFBO[0]);
-    glDeleteFramebuffers(1, &pingpongFBO[2]);
-
-    glDeleteTextures(1, &surface_texture);
-    glDeleteTextures(1, &transparentTexture);
-    glDeleteTextures(1, &cubemapTexture);
-
-    glfwTerminate();
     return 0;
 }
 
@@ -853,6 +1945,7 @@ void processInput(GLFWwindow *window) {
 // glfw: poziva se prilikom promene velicine prozora
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
     glViewport(0, 0, width, height);
+    inputActivity = true;
 }
 
 // glfw: poziva se prilikom pomeraja misa
@@ -863,6 +1956,7 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos) {
         firstMouse = false;
     }
 
+    inputActivity = true;
     float xoffset = xpos - lastX;
     float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
 
@@ -876,6 +1970,12 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos) {
 // glfw: poziva se prilikom skrolovanja misem
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset) {
     programState->camera.ProcessMouseScroll(yoffset);
+    inputActivity = true;
+}
+
+// glfw: poziva se prilikom klika misem (ImGui dobija dogadjaj posle ovoga)
+void mouse_button_callback(GLFWwindow *window, int button, int action, int mods) {
+    inputActivity = true;
 }
 
 // naredba za crtanje Guia
@@ -907,12 +2007,261 @@ void DrawImGui(ProgramState *programState) {
         ImGui::End();
     }
 
+    {
+        ImGui::Begin("LOD");
+        ImGui::Checkbox("LOD enabled", &programState->LodEnabled);
+        ImGui::DragFloat("Max pixel error", &programState->LodPixelError, 0.05, 0.1, 16.0);
+        ImGui::Checkbox("Stress scene", &programState->StressSceneEnabled);
+        ImGui::SliderInt("Stress grid size", &programState->StressGridSize, 1, 40);
+        ImGui::Text("Instances: %u (%u culled)", lodStats.instances, lodStats.culled);
+        ImGui::Text("Triangles drawn: %u / %u (full detail)", lodStats.trianglesDrawn, lodStats.trianglesFull);
+        ImGui::Text("Levels 0/1/2/3: %u / %u / %u / %u", lodStats.levelHistogram[0], lodStats.levelHistogram[1],
+                    lodStats.levelHistogram[2], lodStats.levelHistogram[3]);
+        ImGui::Text("Frame time: %.3f ms", 1000.0f / ImGui::GetIO().Framerate);
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Multi-draw");
+        if (multiDrawState.supported) {
+            ImGui::Checkbox("Multi-draw indirect", &programState->MultiDrawEnabled);
+            ImGui::Checkbox("GPU culling (compute)", &programState->GpuCullingEnabled);
+            const DrawBatchStats *passes[] = {&multiDrawState.opaque, &multiDrawState.emissive, &multiDrawState.clouds,
+                                              &multiDrawState.shadows};
+            const char *names[] = {"Opaque", "Emissive", "Clouds", "Shadows"};
+            for (int i = 0; i < 4; i++)
+                ImGui::Text("%-8s %5u draws, %5u submitted, %5u GPU culled, %u MDI calls, %u texture binds", names[i],
+                            passes[i]->draws, passes[i]->submitted, passes[i]->gpuCulled, passes[i]->multiDrawCalls,
+                            passes[i]->textureBinds);
+            // skybox i post-processing ostaju pojedinacni pozivi
+            ImGui::Text("Skybox and full-screen post passes are still individual draws.");
+            ImGui::Text("Texture array pages:");
+            for (const TextureArrayManager::Page &page : multiDrawState.textureArrays->Pages())
+                ImGui::Text("  %4d x %-4d %2d / %2d layers", page.width, page.height, page.used, page.capacity);
+        } else {
+            ImGui::Text("Needs OpenGL 4.3 (context is %d.%d)", GLVersion.major, GLVersion.minor);
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Occlusion");
+        ImGui::Checkbox("Depth pre-pass", &programState->DepthPrepassEnabled);
+        ImGui::Checkbox("Hi-Z occlusion culling", &programState->HiZCullingEnabled);
+        ImGui::Text("Hi-Z: %u tested, %u occluded", occlusionStats.tested, occlusionStats.occluded);
+        ImGui::Text("Fragments shaded: %llu (%.2f per pixel)", occlusionStats.fragmentsShaded,
+                    occlusionStats.fragmentsShaded / (float) (SCR_WIDTH * SCR_HEIGHT));
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Resolution");
+        ImGui::Checkbox("Temporal upscaling", &programState->TemporalUpscalingEnabled);
+        ImGui::Checkbox("Dynamic resolution", &programState->DynamicResolutionEnabled);
+        ImGui::DragFloat("Target frame time (ms)", &programState->TargetFrameMs, 0.1, 4.0, 100.0);
+        // bez TAA se uvek crta u punoj rezoluciji
+        if (programState->TemporalUpscalingEnabled)
+            ImGui::SliderFloat("Render scale", &programState->RenderScale, 0.5, 1.0);
+        else
+            ImGui::Text("Render scale: 1.00 (needs temporal upscaling)");
+        ImGui::Text("Internal resolution: %d x %d", resolutionStats.renderWidth, resolutionStats.renderHeight);
+        ImGui::Text("GPU frame time: %.2f ms", resolutionStats.gpuFrameMs);
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Image-based lighting");
+        ImGui::Checkbox("Enabled", &programState->IblEnabled);
+        ImGui::SliderFloat("Intensity", &programState->IblIntensity, 0.0, 4.0);
+        if (imageBasedLighting) {
+            ImGui::Text("Skybox hash %016llx", (unsigned long long) imageBasedLighting->hash);
+            if (imageBasedLighting->fromCache)
+                ImGui::Text("Loaded from cache in %.2f ms", imageBasedLighting->loadMs);
+            else
+                ImGui::Text("Baked in %.2f ms (SH9 %.2f ms, prefilter %.2f ms)", imageBasedLighting->loadMs,
+                            imageBasedLighting->shMs, imageBasedLighting->prefilterMs);
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Latency");
+        const FramePacer &pacer = *pacingState.pacer;
+        const FrameLimiter &limiter = *pacingState.limiter;
+        ImGui::Checkbox("Low latency (late input, bounded queue)", &programState->LowLatencyEnabled);
+        ImGui::SliderInt("Max frames in flight", &programState->MaxFramesInFlight, 1, 3);
+        ImGui::Checkbox("VSync", &programState->VsyncEnabled);
+        ImGui::Checkbox("Frame limiter", &programState->FrameLimiterEnabled);
+        ImGui::DragFloat("Limiter FPS", &programState->FrameLimiterFps, 1.0, 10.0, 480.0);
+        ImGui::Text("Input-to-present: %.2f ms (avg %.2f ms)", pacer.latencyMs, pacer.averageLatencyMs);
+        ImGui::PlotLines("##latency", pacer.history, FramePacer::historySize, pacer.historyIndex, "latency (ms)",
+                         0.0f, 100.0f, ImVec2(0, 60));
+        ImGui::Text("Frames in flight: %d, fence wait %.2f ms", pacer.InFlight(), pacer.fenceWaitMs);
+        ImGui::Text("Limiter: sleep %.2f ms, spin %.2f ms (margin %.2f ms), missed %.2f ms", limiter.sleepMs,
+                    limiter.spinMs, limiter.spinMarginMs, limiter.missedMs);
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Particles");
+        ParticleSystem &particles = *particleState.system;
+        const ParticleStats &stats = particles.stats;
+        ImGui::Checkbox("Enabled (B to emit)", &programState->ParticlesEnabled);
+        // Configure pravi nove niti i brise cestice, pa se ne poziva za svaki korak prevlacenja
+        ImGui::SliderInt("Budget", &particleState.budgetEdit, 1000, 1000000);
+        if (ImGui::IsItemDeactivatedAfterEdit())
+            programState->ParticleBudget = particleState.budgetEdit;
+        ImGui::SliderInt("Threads (0 = all)", &particleState.threadsEdit, 0, 32);
+        if (ImGui::IsItemDeactivatedAfterEdit())
+            programState->ParticleThreads = particleState.threadsEdit;
+        ImGui::SliderFloat("Intensity", &programState->ParticleIntensity, 0.0, 16.0);
+        ImGui::Text("Alive: %d / %d (%d spawned), %d threads", stats.alive, particles.Budget(), stats.spawned,
+                    particles.Threads());
+        ImGui::Text("Simulate %.3f ms (%.0f particles/ms)", stats.simulateMs,
+                    stats.simulateMs > 0.0f ? stats.alive / stats.simulateMs : 0.0f);
+        ImGui::Text("Upload %.3f ms, draw %.3f ms GPU (%.0f particles/ms)", stats.uploadMs, stats.drawMs,
+                    stats.drawMs > 0.0f ? stats.alive / stats.drawMs : 0.0f);
+        if (ImGui::Button("CPU benchmark (10k / 100k / 1M)")) {
+            particleState.benchmark.clear();
+            for (int threads : {1, 0})
+                for (int count : {10000, 100000, 1000000})
+                    particleState.benchmark.push_back(RunParticleBenchmark(count, threads, 20));
+        }
+        for (const ParticleBenchmarkResult &result : particleState.benchmark)
+            ImGui::Text("%8d particles, %2d threads: %7.3f ms/step, %9.0f particles/ms", result.count, result.threads,
+                        result.msPerStep, result.ParticlesPerMs());
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Idle");
+        ImGui::RadioButton("Always render", &programState->IdleRenderMode, (int) IdleMode::Off);
+        ImGui::RadioButton("Throttle when idle", &programState->IdleRenderMode, (int) IdleMode::Throttle);
+        ImGui::RadioButton("Freeze when idle", &programState->IdleRenderMode, (int) IdleMode::Freeze);
+        ImGui::SliderFloat("Idle FPS", &programState->IdleFps, 1.0, 30.0);
+        ImGui::Checkbox("Cache static layers", &programState->StaticLayerCacheEnabled);
+        ImGui::Text("State: %s", idleState.idle ? "idle" : "active");
+        ImGui::Text("Frames: %llu rendered, %llu skipped", idleState.controller->renderedFrames,
+                    idleState.controller->skippedFrames);
+        ImGui::Text("Static layers: %llu hits, %llu captures", idleState.staticLayers->hits,
+                    idleState.staticLayers->captures);
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Trace");
+        Tracer &tracer = Tracer::Get();
+        if (!tracer.Enabled()) {
+            if (ImGui::Button("Start (F9)"))
+                tracer.Start(TimestampedTracePath());
+            ImGui::DragInt("Frames", &programState->TraceCaptureFrames, 1, 1, 10000);
+            if (ImGui::Button("Capture frames"))
+                tracer.Start(TimestampedTracePath(), programState->TraceCaptureFrames);
+        } else {
+            if (ImGui::Button("Stop (F9)"))
+                tracer.Stop();
+            if (tracer.FramesLeft() > 0)
+                ImGui::Text("%d frames left", tracer.FramesLeft());
+        }
+        if (!tracer.Path().empty())
+            ImGui::Text("%s: %llu events, %u dropped", tracer.Path().c_str(), tracer.EventsWritten(), tracer.Dropped());
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Assets");
+        ImGui::DragFloat("Upload budget (ms/frame)", &programState->AssetUploadBudgetMs, 0.1, 0.1, 16.0);
+        for (unsigned int i = 0; i < assetManager->Count(); i++) {
+            const ModelAsset &asset = assetManager->Get(i);
+            ImGui::Text("%s", asset.path.c_str());
+            ImGui::Text("  %s, %u meshes, import %.1f ms, upload %.1f ms", AssetStateName(asset.state),
+                        (unsigned int) asset.meshes.size(), asset.importMs, asset.uploadMs);
+            ImGui::ProgressBar(asset.Progress());
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Texture streaming");
+        const TextureStreamer &streamer = *textureStreamer;
+        ImGui::SliderInt("Budget (MB)##streaming", &programState->TextureBudgetMB, 4, 2048);
+        ImGui::SliderFloat("LOD bias", &programState->TextureLodBias, -2.0, 4.0);
+        float resident = streamer.ResidentBytes() / (1024.0f * 1024.0f);
+        float full = streamer.FullBytes() / (1024.0f * 1024.0f);
+        ImGui::Text("Resident: %.2f MB of %d MB budget (all mips: %.2f MB)", resident, programState->TextureBudgetMB, full);
+        ImGui::ProgressBar(resident / programState->TextureBudgetMB);
+        ImGui::Text("Loads %llu, evictions %llu, failed reads %llu, uploaded %.0f KB this frame%s", streamer.loads,
+                    streamer.evictions, streamer.failedReads, streamer.uploadedBytes / 1024.0f,
+                    streamer.budgetLimited ? ", budget limited" : "");
+        for (const StreamedTexture &texture : streamer.Textures()) {
+            const streaming::MipLevel &level = texture.levels[texture.residentLevel];
+            ImGui::Text("%4d x %-4d mip %d/%d%s %7.2f MB  %s", level.width, level.height, texture.residentLevel,
+                        texture.tailLevel, texture.loadingLevel >= 0 ? "+" : texture.failed ? "!" : " ",
+                        texture.residentBytes / (1024.0f * 1024.0f), texture.name.substr(texture.name.find_last_of('/') + 1).c_str());
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Shadows");
+        const CascadedShadowMaps &shadows = *cascadedShadowMaps;
+        ImGui::Checkbox("Cascaded shadows", &programState->ShadowsEnabled);
+        ImGui::Checkbox("Cache static casters", &programState->ShadowCacheEnabled);
+        ImGui::SliderFloat("Strength", &programState->ShadowStrength, 0.0, 1.0);
+        ImGui::SliderFloat("Distance", &programState->ShadowDistance, 10.0, 200.0);
+        ImGui::SliderFloat("Cache margin", &programState->ShadowCacheMargin, 0.0, 1.0);
+        ImGui::Text("Shadow pass: GPU %.3f ms, CPU %.3f ms", shadows.gpuMs, shadows.cpuMs);
+        ImGui::Text("Average GPU: cached %.3f ms, uncached %.3f ms", shadows.cachedGpuMs, shadows.uncachedGpuMs);
+        ImGui::Text("Static casters redrawn: %u of %d cascades", shadows.staticRenders, CascadedShadowMaps::cascadeCount);
+        for (int i = 0; i < CascadedShadowMaps::cascadeCount; i++) {
+            const ShadowCascade &cascade = shadows.Cascade(i);
+            ImGui::Text("Cascade %d: to %.1f, region radius %.1f, rebuilds %u", i, cascade.splitFar, cascade.regionRadius,
+                        cascade.rebuilds);
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("GPU memory");
+        GlResourceRegistry &registry = GlResourceRegistry::Get();
+        ImGui::SliderInt("Warn above (MB)", &programState->GpuMemoryWarningMB, 64, 4096);
+        registry.warningBytes = (size_t) programState->GpuMemoryWarningMB * 1024 * 1024;
+
+        float total = registry.TotalBytes() / (1024.0f * 1024.0f);
+        ImGui::Text("Total: %.2f MB", total);
+        ImGui::ProgressBar(total / programState->GpuMemoryWarningMB);
+        for (int i = 0; i < GlResourceRegistry::typeCount; i++) {
+            GlResourceType type = (GlResourceType) i;
+            ImGui::Text("%-14s %5u  %8.2f MB", GlResourceTypeName(type), (unsigned int) registry.Count(type),
+                        registry.Bytes(type) / (1024.0f * 1024.0f));
+        }
+        ImGui::Separator();
+        ImGui::Text("Largest:");
+        for (const auto &entry : registry.Largest(10))
+            ImGui::Text("%8.2f MB  %s", entry.first / (1024.0f * 1024.0f), entry.second->c_str());
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Frame memory");
+        FrameArena &arena = ThreadFrameArena();
+        ImGui::Text("Heap allocations this frame (render thread): %llu", frameMemoryStats.heapAllocations);
+        ImGui::PlotLines("##allocations", frameMemoryStats.history, 120, frameMemoryStats.historyIndex, "allocations / frame",
+                         0.0f, 64.0f, ImVec2(0, 60));
+        ImGui::Text("Frame arena: %.1f KB used, %.1f KB high water", frameMemoryStats.arenaUsed / 1024.0f,
+                    arena.HighWater() / 1024.0f);
+        ImGui::Text("Frame arena capacity: %.1f KB in %u block(s)", arena.Capacity() / 1024.0f, (unsigned int) arena.BlockCount());
+        ImGui::End();
+    }
+
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
 // glfw: poziva se prilikom dodirivanja tipki
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    inputActivity = true;
+
     if (key == GLFW_KEY_U && action == GLFW_PRESS) {
         programState->ImGuiEnabled = !programState->ImGuiEnabled;
         if (programState->ImGuiEnabled) {
@@ -924,11 +2273,21 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
     }
 
     if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+            programState->PokemonAttackMode = true;
             programState->pointLight.linear = 0.0f;
             programState->pointLight.quadratic = 0.0f;
         }
 
+    // snimanje vremenske linije (Chrome trace) dok se ponovo ne pritisne F9
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+        if (Tracer::Get().Enabled())
+            Tracer::Get().Stop();
+        else
+            Tracer::Get().Start(TimestampedTracePath());
+    }
+
     if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+           programState->PokemonAttackMode = false;
            programState->pointLight.constant = 1.0f;
            programState->pointLight.linear = 0.02f;
            programState->pointLight.quadratic = 0.1f;
@@ -936,55 +2295,12 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 
 }
 
-// ucitavanje teksture + prilagodjeno za HDR
-unsigned int loadTexture(char const * path)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        GLenum iternal;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3) {
-            format = GL_RGB;
-            iternal = GL_SRGB;
-        }
-        else if (nrComponents == 4) {
-            iternal = GL_SRGB_ALPHA;
-            format = GL_RGBA;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, iternal, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT); // for this tutorial: use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes texels from next repeat
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
-
 // ucitavanje tekstura za skybox
-unsigned int loadCubemap(vector<std::string> faces)
+GlTexture loadCubemap(const vector<std::string> &faces)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+    GlTexture textureID = GlTexture::Create("skybox cubemap");
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    size_t bytes = 0;
 
     int width, height, nrChannels;
     for (unsigned int i = 0; i < faces.size(); i++)
@@ -993,6 +2309,7 @@ unsigned int loadCubemap(vector<std::string> faces)
         if (data)
         {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+            bytes += EstimateTextureBytes(GL_SRGB, width, height);
             stbi_image_free(data);
         }
         else
@@ -1006,6 +2323,7 @@ unsigned int loadCubemap(vector<std::string> faces)
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    textureID.SetBytes(bytes);
 
     return textureID;
 }
@@ -1013,11 +2331,11 @@ unsigned int loadCubemap(vector<std::string> faces)
 
 
 // renderovanje za bloom
-unsigned int quadVAO = 0;
-unsigned int quadVBO;
+GlVertexArray quadVAO;
+GlBuffer quadVBO;
 void renderQuad()
 {
-    if (quadVAO == 0)
+    if (quadVAO.Id() == 0)
     {
         float quadVertices[] = {
                 // pozicije                    // koordinate tekstura
@@ -1028,11 +2346,10 @@ void renderQuad()
         };
 
 
-        glGenVertexArrays(1, &quadVAO);
-        glGenBuffers(1, &quadVBO);
+        quadVAO = GlVertexArray::Create("quadVAO");
+        quadVBO = GlBuffer::Create("quadVBO");
         glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        GlBufferData(quadVBO, GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
@@ -1041,4 +2358,11 @@ void renderQuad()
     glBindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     glBindVertexArray(0);
-}
\ No newline at end of file
+}
+
+// globalni quad mora da se oslobodi dok kontekst jos postoji
+void releaseQuad()
+{
+    quadVAO.Reset();
+    quadVBO.Reset();
+}